@@ -5,6 +5,16 @@
 #include <fstream>
 #include <algorithm>
 #include <stdexcept>
+#include <limits>
+#include <string_view>
+#include <chrono>
+#include <cstdio>
+#include <charconv>
+#include <thread>
+#include <filesystem>
+#include <type_traits>
+#include "../common/Bulk_import.h"
+#include "../common/Text_buffer.h"
 
 // Базовый класс User
 class User
@@ -29,7 +39,7 @@ public:
     virtual ~User() = default;
 
     // Геттеры и сеттеры
-    std::string getName() const { return name_; }
+    const std::string &getName() const { return name_; }
     int getId() const { return id_; }
     int getAccessLevel() const { return accessLevel_; }
 
@@ -40,7 +50,16 @@ public:
         name_ = name;
     }
 
-    virtual void displayInfo() const = 0;
+    // Строка с описанием пользователя без перевода строки
+    virtual void appendInfo(TextBuffer &out) const = 0;
+
+    void displayInfo() const
+    {
+        TextBuffer &out = TextBuffer::local();
+        appendInfo(out);
+        out << '\n';
+        out.writeTo(std::cout);
+    }
 
     virtual void serialize(std::ofstream &ofs) const
     {
@@ -75,10 +94,12 @@ public:
             throw std::invalid_argument("Group cannot be empty");
     }
 
-    void displayInfo() const override
+    const std::string &getGroup() const { return group_; }
+
+    void appendInfo(TextBuffer &out) const override
     {
-        std::cout << "Student: " << name_ << ", ID: " << id_
-                  << ", Access Level: " << accessLevel_ << ", Group: " << group_ << std::endl;
+        out << "Student: " << name_ << ", ID: " << id_
+            << ", Access Level: " << accessLevel_ << ", Group: " << group_;
     }
 
     void serialize(std::ofstream &ofs) const override
@@ -112,10 +133,12 @@ public:
             throw std::invalid_argument("Department cannot be empty");
     }
 
-    void displayInfo() const override
+    const std::string &getDepartment() const { return department_; }
+
+    void appendInfo(TextBuffer &out) const override
     {
-        std::cout << "Teacher: " << name_ << ", ID: " << id_
-                  << ", Access Level: " << accessLevel_ << ", Department: " << department_ << std::endl;
+        out << "Teacher: " << name_ << ", ID: " << id_
+            << ", Access Level: " << accessLevel_ << ", Department: " << department_;
     }
 
     void serialize(std::ofstream &ofs) const override
@@ -149,10 +172,12 @@ public:
             throw std::invalid_argument("Role cannot be empty");
     }
 
-    void displayInfo() const override
+    const std::string &getRole() const { return role_; }
+
+    void appendInfo(TextBuffer &out) const override
     {
-        std::cout << "Administrator: " << name_ << ", ID: " << id_
-                  << ", Access Level: " << accessLevel_ << ", Role: " << role_ << std::endl;
+        out << "Administrator: " << name_ << ", ID: " << id_
+            << ", Access Level: " << accessLevel_ << ", Role: " << role_;
     }
 
     void serialize(std::ofstream &ofs) const override
@@ -230,6 +255,23 @@ public:
         users_.push_back(std::move(user));
     }
 
+    // Добавляет пакет пользователей по порядку
+    void addUsers(std::vector<std::unique_ptr<User>> &&users)
+    {
+        users_.reserve(users_.size() + users.size());
+        std::move(users.begin(), users.end(), std::back_inserter(users_));
+        users.clear();
+    }
+
+    size_t userCount() const { return users_.size(); }
+
+    template <typename Visit>
+    void forEachUser(Visit visit) const
+    {
+        for (const auto &user : users_)
+            visit(*user);
+    }
+
     void addResource(const Resource &resource)
     {
         resources_.push_back(resource);
@@ -249,17 +291,26 @@ public:
         return it->checkAccess(user);
     }
 
-    void displayAllUsers() const
+    // Строки копятся в буфере потока и уходят в out кусками по outputBatch байт,
+    // поток сбрасывается один раз в конце
+    void displayAllUsers(std::ostream &out = std::cout) const
     {
         if (users_.empty())
         {
-            std::cout << "No users in the system.\n";
+            out << "No users in the system.\n";
             return;
         }
+        const size_t outputBatch = 64 * 1024;
+        TextBuffer &buffer = TextBuffer::local();
         for (const auto &user : users_)
         {
-            user->displayInfo();
+            user->appendInfo(buffer);
+            buffer << '\n';
+            if (buffer.size() >= outputBatch)
+                buffer.writeTo(out);
         }
+        buffer.writeTo(out);
+        out.flush();
     }
 
     User *findUserByName(const std::string &name) const
@@ -387,6 +438,242 @@ public:
         ifs.close();
     }
 };
+// Отклонённая строка; номер считается от начала куска и сдвигается при слиянии
+struct Reject
+{
+    size_t line;
+    std::string_view text;
+    std::string reason;
+};
+
+// Кусок файла из целых строк, который разбирает один поток
+struct ImportChunk
+{
+    const char *begin = nullptr;
+    const char *end = nullptr;
+    std::vector<std::unique_ptr<User>> users;
+    std::vector<Reject> rejects;
+    size_t lines = 0;
+};
+
+// Разбирает числовые поля и строит пользователя; остальные правила проверяют сами конструкторы,
+// их сообщение становится причиной отказа. Возвращает причину отказа или пустую строку
+std::string makeUser(const std::string_view *fields, std::unique_ptr<User> &user)
+{
+    int id = 0, accessLevel = 0;
+    std::string_view type = fields[0];
+    if (type != "Student" && type != "Teacher" && type != "Administrator")
+        return "unknown user type";
+    if (!parseInt(fields[2], id))
+        return "id is not a number";
+    if (!parseInt(fields[3], accessLevel))
+        return "access level is not a number";
+
+    std::string name(fields[1]), extra(fields[4]);
+    try
+    {
+        if (type == "Student")
+            user = std::make_unique<Student>(name, id, accessLevel, extra);
+        else if (type == "Teacher")
+            user = std::make_unique<Teacher>(name, id, accessLevel, extra);
+        else
+            user = std::make_unique<Administrator>(name, id, accessLevel, extra);
+    }
+    catch (const std::invalid_argument &e)
+    {
+        return e.what();
+    }
+    return {};
+}
+
+void importChunk(ImportChunk &chunk, ImportFormat format)
+{
+    static const std::string_view keys[] = {"type", "name", "id", "accessLevel", "group", "department", "role"};
+    std::string_view fields[7];
+    std::string scratch[8];
+    chunk.lines = forEachLine(chunk.begin, chunk.end, [&](size_t number, std::string_view line)
+    {
+        std::string reason;
+        if (format == ImportFormat::Csv)
+        {
+            if (!splitCsv(line, fields, 5, scratch))
+                reason = "expected 5 CSV fields";
+        }
+        else
+        {
+            int found = parseJson(line, keys, 7, fields, scratch);
+            if (found < 0)
+                reason = "malformed JSON";
+            else if ((found & 0xF) != 0xF)
+                reason = "missing field";
+            else
+            {
+                // Дополнительное поле зависит от типа: group, department или role.
+                // Тип читается только после проверки, что он найден в этой строке
+                int extra = fields[0] == "Student" ? 4 : fields[0] == "Teacher" ? 5 : 6;
+                if (found & (1 << extra))
+                    fields[4] = fields[extra];
+                else
+                    reason = "missing field";
+            }
+        }
+        std::unique_ptr<User> user;
+        if (reason.empty())
+            reason = makeUser(fields, user);
+        if (!reason.empty())
+            chunk.rejects.push_back(Reject{number, line, std::move(reason)});
+        else
+            chunk.users.push_back(std::move(user));
+    });
+}
+
+// Массовый импорт пользователей из CSV (type,name,id,accessLevel,группа/кафедра/роль; заголовок "type,..."
+// пропускается) или JSON Lines ({"type": ..., "name": ..., "id": ..., "accessLevel": ...,
+// "group"|"department"|"role": ...}); формат определяется по первому символу.
+// Файл отображается в память, поля разбираются без копирования, куски из целых строк обрабатываются
+// в threads потоках и добавляются в систему по порядку. Отклонённые строки пишутся в rejectFile
+// как "номер строки<TAB>причина<TAB>исходная строка"
+template <typename T>
+ImportStats importUsers(AccessControlSystem<T> &system, const std::string &filename, const std::string &rejectFile,
+                        size_t threads)
+{
+    MappedFile file(filename, "import");
+    ImportText text = detectImport(file, "type,");
+    std::vector<ImportChunk> chunks;
+    for (const auto &range : splitLineChunks(text, threads))
+    {
+        chunks.emplace_back();
+        chunks.back().begin = range.first;
+        chunks.back().end = range.second;
+    }
+    runParallel(chunks.size(), threads, [&](size_t k)
+                { importChunk(chunks[k], text.format); });
+
+    std::ofstream rejects(rejectFile, std::ios::binary);
+    if (!rejects)
+        throw std::runtime_error("Cannot open reject file");
+    ImportStats stats;
+    size_t line = text.headerLines;
+    for (ImportChunk &chunk : chunks)
+    {
+        stats.imported += chunk.users.size();
+        system.addUsers(std::move(chunk.users));
+        for (const Reject &reject : chunk.rejects)
+            rejects << line + reject.line << '\t' << reject.reason << '\t' << reject.text << '\n';
+        stats.rejected += chunk.rejects.size();
+        line += chunk.lines;
+    }
+    if (!rejects.flush())
+        throw std::runtime_error("Failed to write reject file");
+    return stats;
+}
+
+// Замер импорта: генерирует CSV и JSON Lines по rows пользователей (каждый сотый с ошибкой) и загружает их
+void runImportBenchmark(size_t rows, size_t threads)
+{
+    const char *types[] = {"Student", "Teacher", "Administrator"};
+    const char *extraKeys[] = {"group", "department", "role"};
+    const char *extras[] = {"CS-101", "Mathematics", "Dean"};
+    for (ImportFormat format : {ImportFormat::Csv, ImportFormat::JsonLines})
+    {
+        bool csv = format == ImportFormat::Csv;
+        const std::string filename = csv ? "import_bench.csv" : "import_bench.jsonl";
+        {
+            std::ofstream out(filename, std::ios::binary);
+            std::string buffer = csv ? "type,name,id,accessLevel,extra\n" : "";
+            for (size_t i = 0; i < rows; ++i)
+            {
+                std::string number = std::to_string(i);
+                bool broken = i % 100 == 99;
+                const char *type = broken && i % 200 == 99 ? "Guest" : types[i % 3];
+                std::string level = broken && i % 200 == 199 ? "-1" : std::to_string(i % 10);
+                if (csv)
+                    buffer += std::string(type) + ",User " + number + "," + number + "," + level + "," + extras[i % 3] + "\n";
+                else
+                    buffer += std::string("{\"type\": \"") + type + "\", \"name\": \"User " + number + "\", \"id\": " +
+                              number + ", \"accessLevel\": " + level + ", \"" + extraKeys[i % 3] + "\": \"" +
+                              extras[i % 3] + "\"}\n";
+                if (buffer.size() >= (1 << 20))
+                {
+                    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                    buffer.clear();
+                }
+            }
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        }
+
+        AccessControlSystem<int> system;
+        auto started = std::chrono::steady_clock::now();
+        ImportStats stats = importUsers(system, filename, "import_bench.rejects", threads);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        std::remove(filename.c_str());
+        std::remove("import_bench.rejects");
+        if (stats.imported + stats.rejected != rows || system.userCount() != stats.imported)
+            throw std::runtime_error("Import lost records");
+        std::cout << (csv ? "CSV" : "JSON Lines") << ": " << rows / seconds << " rows/sec, imported "
+                  << stats.imported << ", rejected " << stats.rejected << std::endl;
+    }
+}
+
+// Прежний displayInfo подклассов без изменений: цепочка operator<< со сбросом потока после строки.
+// Остаётся только для замера; dynamic_cast заменяет прежний виртуальный вызов
+void displayInfoUnbuffered(const User &user, std::ostream &out)
+{
+    if (const auto *student = dynamic_cast<const Student *>(&user))
+        out << "Student: " << student->getName() << ", ID: " << student->getId()
+            << ", Access Level: " << student->getAccessLevel() << ", Group: " << student->getGroup() << std::endl;
+    else if (const auto *teacher = dynamic_cast<const Teacher *>(&user))
+        out << "Teacher: " << teacher->getName() << ", ID: " << teacher->getId()
+            << ", Access Level: " << teacher->getAccessLevel() << ", Department: " << teacher->getDepartment()
+            << std::endl;
+    else if (const auto *administrator = dynamic_cast<const Administrator *>(&user))
+        out << "Administrator: " << administrator->getName() << ", ID: " << administrator->getId()
+            << ", Access Level: " << administrator->getAccessLevel() << ", Role: " << administrator->getRole()
+            << std::endl;
+}
+
+// Замер вывода списка пользователей в файл: построчно прежним displayInfo с std::endl
+// и пакетно через displayAllUsers; текст у обоих способов одинаковый, размеры файлов сверяются
+void runDisplayBenchmark(size_t count)
+{
+    AccessControlSystem<int> system;
+    std::vector<std::unique_ptr<User>> users;
+    users.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        int id = static_cast<int>(i);
+        std::string name = "User " + std::to_string(i);
+        if (i % 3 == 0)
+            users.push_back(std::make_unique<Student>(name, id, id % 10, "CS-101"));
+        else if (i % 3 == 1)
+            users.push_back(std::make_unique<Teacher>(name, id, id % 10, "Mathematics"));
+        else
+            users.push_back(std::make_unique<Administrator>(name, id, id % 10, "Dean"));
+    }
+    system.addUsers(std::move(users));
+
+    const std::string filenames[2] = {"display_bench_old.txt", "display_bench.txt"};
+    double seconds[2];
+    for (int batched = 0; batched < 2; ++batched)
+    {
+        std::ofstream out(filenames[batched]);
+        auto started = std::chrono::steady_clock::now();
+        if (batched)
+            system.displayAllUsers(out);
+        else
+            system.forEachUser([&out](const User &user) { displayInfoUnbuffered(user, out); });
+        out.close();
+        seconds[batched] = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    }
+    bool same = std::filesystem::file_size(filenames[0]) == std::filesystem::file_size(filenames[1]);
+    std::remove(filenames[0].c_str());
+    std::remove(filenames[1].c_str());
+    if (!same)
+        throw std::runtime_error("Display benchmark outputs differ");
+    std::cout << "Line by line with std::endl: " << count / seconds[0] << " lines/sec\n"
+              << "Batched displayAllUsers: " << count / seconds[1] << " lines/sec" << std::endl;
+}
+
 void displayMenu()
 {
     std::cout << "\nMenu:\n"
@@ -400,6 +687,7 @@ void displayMenu()
               << "8. Save Data to File\n"
               << "9. Load Data from File\n"
               << "10. Exit\n"
+              << "11. Import Users from CSV/JSONL\n"
               << "Enter your choice: ";
 }
 
@@ -523,8 +811,44 @@ void loadData(AccessControlSystem<int> &system)
     }
 }
 
+void importData(AccessControlSystem<int> &system)
+{
+    std::cout << "Enter filename to import users: ";
+    std::string filename;
+    std::cin.ignore();
+    std::getline(std::cin, filename);
+
+    try
+    {
+        ImportStats stats = importUsers(system, filename, filename + ".rejects",
+                                        std::max(1u, std::thread::hardware_concurrency()));
+        std::cout << "Imported " << stats.imported << " users, rejected " << stats.rejected << ".\n";
+        if (stats.rejected > 0)
+            std::cout << "Rejected rows are listed in " << filename << ".rejects.\n";
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error importing data: " << e.what() << std::endl;
+    }
+}
+
 // Основная программа
-int main() {
+// Запуск: 10_0 [--import-bench [записей] [потоков] | --display-bench [записей]]
+int main(int argc, char *argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--import-bench" || mode == "--display-bench") {
+        try {
+            if (mode == "--display-bench")
+                runDisplayBenchmark(argc > 2 ? std::stoul(argv[2]) : 1000000);
+            else
+                runImportBenchmark(argc > 2 ? std::stoul(argv[2]) : 2000000,
+                                   argc > 3 ? std::stoul(argv[3]) : std::max(1u, std::thread::hardware_concurrency()));
+        } catch (const std::exception &e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
     try {
         AccessControlSystem<int> system;
 
@@ -567,6 +891,9 @@ int main() {
                 case 10:
                     std::cout << "Exiting...\n";
                     break;
+                case 11:
+                    importData(system);
+                    break;
                 default:
                     std::cout << "Invalid choice. Try again.\n";
             }
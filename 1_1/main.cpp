@@ -1,5 +1,78 @@
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include "../common/Text_buffer.h"
+
+// Счётчик выделений памяти для проверки --alloc-check. Замена глобальных operator new/delete
+// действует во всей программе, поэтому считает она только при включённом countAllocations
+static bool countAllocations = false;
+static size_t heapAllocations = 0;
+
+void *operator new(size_t size)
+{
+    if (countAllocations)
+    {
+        ++heapAllocations;
+    }
+    if (void *memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+// Кэш базового урона для пар (версия характеристик атакующего, версия характеристик цели).
+// При изменении атаки или защиты персонаж получает новую версию, и старые записи перестают совпадать
+class DamageCache
+{
+public:
+    struct Entry
+    {
+        unsigned long long key = 0;
+        int damage = 0;     // 0 — удар не пробивает защиту
+        int hitsToKill = 0; // Ударов до гибели цели с полным здоровьем, 0 — убить нельзя
+    };
+
+private:
+    static const unsigned slotCount = 64;
+    Entry slots[slotCount];
+    int hits = 0;
+    int misses = 0;
+
+public:
+    template <typename Compute>
+    const Entry &lookup(unsigned attackerVersion, unsigned defenderVersion, Compute compute)
+    {
+        unsigned long long key = (static_cast<unsigned long long>(attackerVersion) << 32) | defenderVersion;
+        Entry &entry = slots[(attackerVersion * 31 + defenderVersion) % slotCount];
+        if (entry.key == key)
+        {
+            ++hits;
+            return entry;
+        }
+        ++misses;
+        entry = compute();
+        entry.key = key;
+        return entry;
+    }
+
+    int getHits() const { return hits; }
+    int getMisses() const { return misses; }
+};
 
 class Character
 {
@@ -8,11 +81,46 @@ private:
     int health;       // Приватное поле: уровень здоровья
     int attack;       // Приватное поле: уровень атаки
     int defense;      // Приватное поле: уровень защиты
+    unsigned statVersion; // Приватное поле: версия характеристик для кэша урона
+
+    static const int maxHealth = 100;
+    inline static DamageCache damageCache;
+
+    static unsigned nextStatVersion()
+    {
+        static unsigned counter = 0;
+        return ++counter; // Версия 0 не выдаётся, поэтому пустые записи кэша не совпадают ни с чем
+    }
+
+    DamageCache::Entry computeDamage(const Character &enemy) const
+    {
+        DamageCache::Entry entry;
+        entry.damage = std::max(0, attack - enemy.defense);
+        entry.hitsToKill = entry.damage > 0 ? (maxHealth + entry.damage - 1) / entry.damage : 0;
+        return entry;
+    }
+
+    const DamageCache::Entry &baseDamage(const Character &enemy)
+    {
+        return damageCache.lookup(statVersion, enemy.statVersion, [&] { return computeDamage(enemy); });
+    }
 
 public:
-    // Конструктор для инициализации данных
-    Character(const std::string &n, int h, int a, int d)
-        : name(n), health(h), attack(a), defense(d) {}
+    // Конструктор для инициализации данных; имя принимается по значению и перемещается в поле,
+    // поэтому временная строка не копируется
+    Character(std::string n, int h, int a, int d)
+        : name(std::move(n)), health(h), attack(a), defense(d), statVersion(nextStatVersion()) {}
+
+    Character(const Character &) = default;
+    Character(Character &&) noexcept = default;
+    Character &operator=(const Character &) = default;
+    Character &operator=(Character &&) noexcept = default;
+
+    // Метод для получения имени без копирования строки
+    std::string_view getName() const noexcept
+    {
+        return name;
+    }
 
     // Метод для получения уровня здоровья
     int getHealth() const
@@ -20,17 +128,18 @@ public:
         return health;
     }
 
-    // Метод для вывода информации о персонаже
+    // Метод для вывода информации о персонаже: строка собирается в буфере потока и выводится одним write
     void displayInfo() const
     {
-        std::cout << "Name: " << name << ", HP: " << health
-                  << ", Attack: " << attack << ", Defense: " << defense << std::endl;
+        TextBuffer &out = TextBuffer::local();
+        out << "Name: " << name << ", HP: " << health << ", Attack: " << attack << ", Defense: " << defense << '\n';
+        out.writeTo(std::cout);
     }
 
     // Метод для атаки другого персонажа
     void attackEnemy(Character &enemy)
     {
-        int damage = attack - enemy.defense;
+        int damage = baseDamage(enemy).damage;
         if (damage > 0)
         {
             enemy.health -= damage;
@@ -41,14 +150,25 @@ public:
             std::cout << name << " attacks " << enemy.name << ", but it has no effect!" << std::endl;
         }
     }
+    // Сколько ударов нужно, чтобы победить противника с полным здоровьем (0 — невозможно)
+    int hitsToKill(const Character &enemy)
+    {
+        return baseDamage(enemy).hitsToKill;
+    }
+
+    static const DamageCache &getDamageCache()
+    {
+        return damageCache;
+    }
+
     void heal(int amount)
     {
-        if (health<100)
+        if (health<maxHealth)
         {
             health+=amount;
-            if (health>100)
+            if (health>maxHealth)
             {
-                health=100;
+                health=maxHealth;
             }
             ;
         }
@@ -62,8 +182,55 @@ public:
     }
 };
 
-int main()
+static_assert(std::is_nothrow_move_constructible<Character>::value, "Character must move without throwing");
+
+// Поток, который отбрасывает вывод и не выделяет память
+class NullBuffer : public std::streambuf
+{
+protected:
+    int overflow(int c) override { return c; }
+};
+
+// Бой до гибели монстра, rounds раз подряд; после первого раунда бой не должен выделять память
+int runAllocationCheck(int rounds)
 {
+    if (rounds < 2)
+    {
+        std::cerr << "Error: --alloc-check needs at least 2 rounds, the first one only warms up" << std::endl;
+        return 2;
+    }
+    Character hero("Hero", 100, 20, 10);
+    Character monster("Goblin", 50, 15, 5);
+    NullBuffer nothing;
+    std::streambuf *console = std::cout.rdbuf(&nothing);
+    for (int round = 0; round < rounds; ++round)
+    {
+        if (round == 1)
+        {
+            countAllocations = true; // Первый раунд прогревает кэш урона и буфер потока
+        }
+        monster.heal(100);
+        while (monster.getHealth() > 0)
+        {
+            hero.attackEnemy(monster);
+            monster.attackEnemy(hero);
+            hero.heal(100);
+        }
+    }
+    countAllocations = false;
+    std::cout.rdbuf(console);
+    std::cout << "Battle loop: " << rounds - 1 << " rounds, " << heapAllocations << " heap allocations" << std::endl;
+    return heapAllocations == 0 ? 0 : 1;
+}
+
+// Запуск: 1_1 [--alloc-check [раундов]]
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && std::string_view(argv[1]) == "--alloc-check")
+    {
+        return runAllocationCheck(argc > 2 ? std::atoi(argv[2]) : 10000);
+    }
+
     // Создаем объекты персонажей
     Character hero("Hero", 100, 20, 10);
     Character monster("Goblin", 50, 15, 5);
@@ -75,6 +242,7 @@ int main()
     // Герой атакует монстра
     hero.attackEnemy(monster);
     monster.displayInfo();
+    std::cout << "Hero needs " << hero.hitsToKill(monster) << " hits to defeat Goblin at full health" << std::endl;
 
     // Во время удара герой повреждает свою руку
     hero.takeDamage(10);
@@ -84,5 +252,8 @@ int main()
     monster.heal(15);
     monster.displayInfo();
 
+    const DamageCache &cache = Character::getDamageCache();
+    std::cout << "Damage cache: " << cache.getHits() << " hits, " << cache.getMisses() << " misses" << std::endl;
+
     return 0;
 }
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <string>
+#include "../common/Text_buffer.h"
 
 class Entity {
 protected:
@@ -10,9 +11,16 @@ public:
     // Конструктор базового класса
     Entity(const std::string& n, int h) : name(n), health(h) {}
 
-    // Метод для вывода информации
-    virtual void displayInfo() const {
-        std::cout << "Name: " << name << ", HP: " << health << std::endl;
+    // Дописывает строки с информацией в out; подклассы дополняют её своими полями
+    virtual void appendInfo(TextBuffer &out) const {
+        out << "Name: " << name << ", HP: " << health << '\n';
+    }
+
+    // Метод для вывода информации: текст собирается в буфере потока и выводится одним write
+    void displayInfo() const {
+        TextBuffer &out = TextBuffer::local();
+        appendInfo(out);
+        out.writeTo(std::cout);
     }
 
     virtual ~Entity() {}
@@ -27,10 +35,10 @@ public:
     Player(const std::string& n, int h, int exp)
         : Entity(n, h), experience(exp) {}
 
-    // Переопределение метода displayInfo
-    void displayInfo() const override {
-        Entity::displayInfo(); // Вызов метода базового класса
-        std::cout << "Experience: " << experience << std::endl;
+    // Переопределение метода appendInfo
+    void appendInfo(TextBuffer &out) const override {
+        Entity::appendInfo(out); // Вызов метода базового класса
+        out << "Experience: " << experience << '\n';
     }
 };
 
@@ -43,10 +51,10 @@ public:
     Enemy(const std::string& n, int h, const std::string& t)
         : Entity(n, h), type(t) {}
 
-    // Переопределение метода displayInfo
-    void displayInfo() const override {
-        Entity::displayInfo(); // Вызов метода базового класса
-        std::cout << "Type: " << type << std::endl;
+    // Переопределение метода appendInfo
+    void appendInfo(TextBuffer &out) const override {
+        Entity::appendInfo(out); // Вызов метода базового класса
+        out << "Type: " << type << '\n';
     }
 };
 
@@ -56,9 +64,9 @@ private:
 public:
     Boss(const std::string& n, int h, const std::string& t, const std::string& sa)
         : Enemy(n,h,t), specialAbility(sa){}
-    void displayInfo() const override{
-        Enemy::displayInfo();
-        std::cout << "Special Ability: " << specialAbility << std::endl;
+    void appendInfo(TextBuffer &out) const override{
+        Enemy::appendInfo(out);
+        out << "Special Ability: " << specialAbility << '\n';
     }
 };
 
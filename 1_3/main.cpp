@@ -1,5 +1,54 @@
 #include <iostream>
 #include <string>
+#include <algorithm>
+#include <variant>
+#include <vector>
+#include <type_traits>
+#include <string_view>
+#include <memory>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include "../common/Text_buffer.h"
+
+// Кэш базового урона для пар (версия характеристик атакующего, версия характеристик цели).
+// При изменении атаки или защиты персонаж получает новую версию, и старые записи перестают совпадать
+class DamageCache
+{
+public:
+    struct Entry
+    {
+        unsigned long long key = 0;
+        int damage = 0;     // 0 — удар не пробивает защиту
+        int hitsToKill = 0; // Ударов до гибели цели с полным здоровьем, 0 — убить нельзя
+    };
+
+private:
+    static const unsigned slotCount = 64;
+    Entry slots[slotCount];
+    int hits = 0;
+    int misses = 0;
+
+public:
+    template <typename Compute>
+    const Entry &lookup(unsigned attackerVersion, unsigned defenderVersion, Compute compute)
+    {
+        unsigned long long key = (static_cast<unsigned long long>(attackerVersion) << 32) | defenderVersion;
+        Entry &entry = slots[(attackerVersion * 31 + defenderVersion) % slotCount];
+        if (entry.key == key)
+        {
+            ++hits;
+            return entry;
+        }
+        ++misses;
+        entry = compute();
+        entry.key = key;
+        return entry;
+    }
+
+    int getHits() const { return hits; }
+    int getMisses() const { return misses; }
+};
 
 class Entity
 {
@@ -8,14 +57,49 @@ protected:
     int health;
     int attack;
     int defense;
+    int maxHealth;        // Здоровье при создании, от него считается число ударов до победы
+    unsigned statVersion; // Версия характеристик для кэша урона
+
+    static unsigned nextStatVersion()
+    {
+        static unsigned counter = 0;
+        return ++counter; // Версия 0 не выдаётся, поэтому пустые записи кэша не совпадают ни с чем
+    }
+
+    DamageCache::Entry computeDamage(const Entity &target) const
+    {
+        DamageCache::Entry entry;
+        entry.damage = std::max(0, attack - target.defense);
+        entry.hitsToKill = entry.damage > 0 ? (target.maxHealth + entry.damage - 1) / entry.damage : 0;
+        return entry;
+    }
+
+    // Строка "<label><имя>, HP: ..., Attack: ..., Defense: ..." с переводом строки
+    void appendStats(TextBuffer &out, const char *label) const
+    {
+        out << label << name << ", HP: " << health << ", Attack: " << attack << ", Defense: " << defense << '\n';
+    }
+
+    // Базовый урон по цели без случайных модификаторов
+    const DamageCache::Entry &baseDamage(const Entity &target) const
+    {
+        return damageCache().lookup(statVersion, target.statVersion, [&] { return computeDamage(target); });
+    }
+
 public:
     Entity(const std::string &n, int h, int a, int d)
-        : name(n), health(h), attack(a), defense(d) {}
+        : name(n), health(h), attack(a), defense(d), maxHealth(h), statVersion(nextStatVersion()) {}
+
+    static DamageCache &damageCache()
+    {
+        static DamageCache cache;
+        return cache;
+    }
 
     // Виртуальный метод для атаки
     virtual void attackEnemy(Entity &target)
     {
-        int damage = attack - target.defense;
+        int damage = baseDamage(target).damage;
         if (damage > 0)
         {
             target.health -= damage;
@@ -34,12 +118,18 @@ public:
     std::string getName() const { return name; }
 
     void takeDamage(int damage) { health -= damage; }
+    // Сколько ударов без модификаторов нужно, чтобы победить цель с полным здоровьем (0 — невозможно)
+    int hitsToKill(const Entity &target) const { return baseDamage(target).hitsToKill; }
 
-    // Виртуальный метод для вывода информации
-    virtual void displayInfo() const
+    // Виртуальный метод, дописывающий информацию о сущности в out
+    virtual void appendInfo(TextBuffer &out) const { appendStats(out, "Name: "); }
+
+    // Вывод информации одним write, без сброса потока после строки
+    void displayInfo() const
     {
-        std::cout << "Name: " << name << ", HP: " << health
-                  << ", Attack: " << attack << ", Defense: " << defense << std::endl;
+        TextBuffer &out = TextBuffer::local();
+        appendInfo(out);
+        out.writeTo(std::cout);
     }
 
     // Виртуальный деструктор
@@ -54,7 +144,7 @@ public:
     // Переопределение метода attack
     void attackEnemy(Entity& target) override
     {
-        int damage = attack - target.getDefence();
+        int damage = baseDamage(target).damage;
         if (damage > 0)
         {
             // Шанс на критический удар (20%)
@@ -76,12 +166,8 @@ public:
         std::cout<<"Character healed with "<< amount<< " HP"<<std::endl;
     }
 
-    // Переопределение метода displayInfo
-    void displayInfo() const override
-    {
-        std::cout << "Character: " << name << ", HP: " << health
-                  << ", Attack: " << attack << ", Defense: " << defense << std::endl;
-    }
+    // Переопределение метода appendInfo
+    void appendInfo(TextBuffer &out) const override { appendStats(out, "Character: "); }
 };
 
 class Monster : public Entity
@@ -93,7 +179,7 @@ public:
     // Переопределение метода attack
     void attackEnemy(Entity& target) override
     {
-        int damage = attack - target.getDefence();
+        int damage = baseDamage(target).damage;
         if (damage > 0)
         {
             // Шанс на ядовитую атаку (30%)
@@ -111,12 +197,8 @@ public:
         }
     }
 
-    // Переопределение метода displayInfo
-    void displayInfo() const override
-    {
-        std::cout << "Monster: " << name << ", HP: " << health
-                  << ", Attack: " << attack << ", Defense: " << defense << std::endl;
-    }
+    // Переопределение метода appendInfo
+    void appendInfo(TextBuffer &out) const override { appendStats(out, "Monster: "); }
 };
 class Boss : public Monster
 {
@@ -134,8 +216,134 @@ public:
         std::cout << "Boss used Special Ability! It takes " << damage << " damage" << std::endl;
     }
 };
-int main()
+
+// Сущность по значению: конкретный тип хранится в индексе variant, поэтому сущности можно
+// держать подряд в одном векторе, а вызовы идут напрямую, без поиска по vtable
+using EntityValue = std::variant<Character, Monster, Boss>;
+
+inline Entity &asEntity(EntityValue &entity)
+{
+    return std::visit([](auto &concrete) -> Entity & { return concrete; }, entity);
+}
+
+// Квалифицированный вызов Type::method отключает виртуальную диспетчеризацию
+inline void attackEnemy(EntityValue &attacker, EntityValue &target)
+{
+    Entity &victim = asEntity(target);
+    std::visit([&victim](auto &self)
+               {
+                   using Type = std::decay_t<decltype(self)>;
+                   self.Type::attackEnemy(victim);
+               },
+               attacker);
+}
+
+inline void heal(EntityValue &entity, int amount)
+{
+    std::visit([amount](auto &self)
+               {
+                   using Type = std::decay_t<decltype(self)>;
+                   self.Type::heal(amount);
+               },
+               entity);
+}
+
+inline void displayInfo(const EntityValue &entity)
 {
+    TextBuffer &out = TextBuffer::local();
+    std::visit([&out](const auto &self)
+               {
+                   using Type = std::decay_t<decltype(self)>;
+                   self.Type::appendInfo(out);
+               },
+               entity);
+    out.writeTo(std::cout);
+}
+// Сравнение виртуальной диспетчеризации и std::variant на count сущностях: каждая атакует
+// следующую и лечится. Указатели перемешаны, как у объектов, созданных в разное время игры;
+// варианты лежат подряд. Сообщения о бое отключены, чтобы замерялись вызовы, а не вывод
+int runDispatchBenchmark(size_t count)
+{
+    if (count < 2)
+    {
+        std::cerr << "Error: --bench needs at least 2 entities" << std::endl;
+        return 2;
+    }
+    const int trials = 3;
+    std::vector<std::unique_ptr<Entity>> owned;
+    std::vector<EntityValue> values;
+    owned.reserve(count);
+    values.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        switch (i % 3)
+        {
+        case 0:
+            owned.push_back(std::make_unique<Character>("Hero", 1000000, 20, 10));
+            values.emplace_back(Character("Hero", 1000000, 20, 10));
+            break;
+        case 1:
+            owned.push_back(std::make_unique<Monster>("Goblin", 1000000, 15, 5));
+            values.emplace_back(Monster("Goblin", 1000000, 15, 5));
+            break;
+        default:
+            owned.push_back(std::make_unique<Boss>("Kailth", 1000000, 50, 20, "Fireball", 30));
+            values.emplace_back(Boss("Kailth", 1000000, 50, 20, "Fireball", 30));
+        }
+    }
+    srand(1);
+    for (size_t i = count - 1; i > 0; --i)
+    {
+        std::swap(owned[i], owned[static_cast<size_t>(rand()) % (i + 1)]);
+    }
+    std::vector<Entity *> pointers;
+    pointers.reserve(count);
+    for (const auto &entity : owned)
+    {
+        pointers.push_back(entity.get());
+    }
+
+    auto seconds = [](std::chrono::steady_clock::time_point started)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    };
+    double virtualBest = 1e30, variantBest = 1e30;
+    std::cout.setstate(std::ios::badbit); // Вывод в поток с badbit сразу возвращается
+    for (int trial = 0; trial < trials; ++trial)
+    {
+        srand(1); // Одинаковые критические удары и яд в обоих вариантах
+        auto started = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i)
+        {
+            pointers[i]->attackEnemy(*pointers[(i + 1) % count]);
+            pointers[i]->heal(1);
+        }
+        virtualBest = std::min(virtualBest, seconds(started));
+
+        srand(1);
+        started = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i)
+        {
+            attackEnemy(values[i], values[(i + 1) % count]);
+            heal(values[i], 1);
+        }
+        variantBest = std::min(variantBest, seconds(started));
+    }
+    std::cout.clear();
+    std::cout << "Attack loop over " << count << " entities, best of " << trials << " trials:\n"
+              << "Virtual dispatch (Entity *): " << count / virtualBest << " attacks/sec\n"
+              << "std::variant by value: " << count / variantBest << " attacks/sec" << std::endl;
+    return 0;
+}
+
+// Запуск: 1_3 [--bench [сущностей]]
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && std::string_view(argv[1]) == "--bench")
+    {
+        return runDispatchBenchmark(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000000);
+    }
+
     srand(static_cast<unsigned>(time(0))); // Инициализация генератора случайных чисел
 
     // Создание объектов
@@ -163,5 +371,25 @@ int main()
     boss.attackEnemy(hero);
     hero.displayInfo();
 
+    std::cout << "Hero needs " << hero.hitsToKill(goblin) << " hits to defeat a Goblin\n";
+    const DamageCache &cache = Entity::damageCache();
+    std::cout << "Damage cache: " << cache.getHits() << " hits, " << cache.getMisses() << " misses\n";
+
+    // Тот же бой с сущностями, хранящимися по значению в непрерывном массиве
+    std::vector<EntityValue> party;
+    party.reserve(3);
+    party.emplace_back(Character("Hero", 100, 20, 10));
+    party.emplace_back(Monster("Goblin", 50, 15, 5));
+    party.emplace_back(Boss("Kailth", 300, 50, 20, "Fireball", 30));
+    for (const EntityValue &entity : party)
+    {
+        displayInfo(entity);
+    }
+    attackEnemy(party[0], party[1]);
+    attackEnemy(party[1], party[0]);
+    heal(party[0], 50);
+    attackEnemy(party[2], party[0]);
+    displayInfo(party[0]);
+
     return 0;
 }
@@ -1,7 +1,207 @@
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <type_traits>
+#include <array>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include "../common/Text_buffer.h"
 
-class Character {
+// Трассировка жизненного цикла. Уровень выбирается при компиляции: -DLIFECYCLE_TRACE=<уровень>.
+// По умолчанию LIFECYCLE_TRACE_CONSOLE: лабораторная печатает сообщения, как и раньше.
+// При LIFECYCLE_TRACE_OFF база Traced пуста и в конструкторы не попадает ни одной инструкции
+#define LIFECYCLE_TRACE_OFF 0
+#define LIFECYCLE_TRACE_COUNTERS 1 // Счётчики по типам: живые объекты, создания, копии, перемещения, new
+#define LIFECYCLE_TRACE_EVENTS 2   // Плюс последние события в кольцевом буфере
+#define LIFECYCLE_TRACE_CONSOLE 3  // Плюс печать "created!"/"destroyed!" в std::cout, как раньше
+#ifndef LIFECYCLE_TRACE
+#define LIFECYCLE_TRACE LIFECYCLE_TRACE_CONSOLE
+#endif
+
+#if LIFECYCLE_TRACE >= LIFECYCLE_TRACE_CONSOLE
+#define LIFECYCLE_PRINT(message) (std::cout << message << std::endl)
+#else
+#define LIFECYCLE_PRINT(message) ((void)0)
+#endif
+
+enum class LifecycleEvent : uint8_t
+{
+    Created,
+    Copied,
+    Moved,
+    CopyAssigned,
+    MoveAssigned,
+    Destroyed
+};
+
+// Счётчики одного типа; все типы связаны в список для вывода. Программа однопоточная, атомики не нужны
+struct LifecycleCounters
+{
+    const char *type;
+    size_t live = 0;
+    size_t peak = 0;
+    size_t constructed = 0;
+    size_t copies = 0;
+    size_t moves = 0;
+    size_t destroyed = 0;
+    size_t allocations = 0; // Объекты, созданные через new
+    LifecycleCounters *nextType;
+
+    explicit LifecycleCounters(const char *type) : type(type), nextType(first())
+    {
+        first() = this;
+    }
+    static LifecycleCounters *&first()
+    {
+        static LifecycleCounters *head = nullptr;
+        return head;
+    }
+};
+
+// Последние capacity событий; запись не выделяет память, старые события перезаписываются
+class LifecycleLog
+{
+private:
+    struct Record
+    {
+        uint64_t sequence;
+        const char *type;
+        const void *object;
+        LifecycleEvent event;
+    };
+    static constexpr size_t capacity = 256;
+    std::array<Record, capacity> records{};
+    uint64_t next = 0;
+
+public:
+    static LifecycleLog &instance()
+    {
+        static LifecycleLog log;
+        return log;
+    }
+
+    void record(const char *type, const void *object, LifecycleEvent event)
+    {
+        records[next % capacity] = Record{next, type, object, event};
+        ++next;
+    }
+
+    void dump(std::ostream &out) const
+    {
+        static const char *const names[] = {"created", "copied", "moved", "copy-assigned", "move-assigned",
+                                            "destroyed"};
+        uint64_t begin = next > capacity ? next - capacity : 0;
+        out << "Last " << next - begin << " of " << next << " lifecycle events:\n";
+        for (uint64_t i = begin; i < next; ++i)
+        {
+            const Record &record = records[i % capacity];
+            out << "  #" << record.sequence << ' ' << record.type << ' ' << record.object << ' '
+                << names[static_cast<int>(record.event)] << '\n';
+        }
+    }
+};
+
+// База для отслеживаемых типов: T объявляет static constexpr const char *lifecycleName.
+// Копирование и перемещение T проходят через конструкторы базы и поэтому тоже учитываются
+template <typename T>
+class Traced
+{
+#if LIFECYCLE_TRACE >= LIFECYCLE_TRACE_COUNTERS
+private:
+    void note(LifecycleEvent event) const
+    {
+        LifecycleCounters &counters = lifecycleCounters();
+        switch (event)
+        {
+        case LifecycleEvent::Copied:
+        case LifecycleEvent::CopyAssigned:
+            ++counters.copies;
+            break;
+        case LifecycleEvent::Moved:
+        case LifecycleEvent::MoveAssigned:
+            ++counters.moves;
+            break;
+        default:
+            break;
+        }
+        if (event == LifecycleEvent::Created || event == LifecycleEvent::Copied || event == LifecycleEvent::Moved)
+        {
+            ++counters.constructed;
+            counters.peak = std::max(counters.peak, ++counters.live);
+        }
+        else if (event == LifecycleEvent::Destroyed)
+        {
+            ++counters.destroyed;
+            --counters.live;
+        }
+#if LIFECYCLE_TRACE >= LIFECYCLE_TRACE_EVENTS
+        LifecycleLog::instance().record(T::lifecycleName, this, event);
+#endif
+    }
+
+protected:
+    Traced() { note(LifecycleEvent::Created); }
+    Traced(const Traced &) { note(LifecycleEvent::Copied); }
+    Traced(Traced &&) noexcept { note(LifecycleEvent::Moved); }
+    Traced &operator=(const Traced &)
+    {
+        note(LifecycleEvent::CopyAssigned);
+        return *this;
+    }
+    Traced &operator=(Traced &&) noexcept
+    {
+        note(LifecycleEvent::MoveAssigned);
+        return *this;
+    }
+    ~Traced() { note(LifecycleEvent::Destroyed); }
+
+public:
+    static LifecycleCounters &lifecycleCounters()
+    {
+        static LifecycleCounters counters(T::lifecycleName);
+        return counters;
+    }
+    static void *operator new(size_t size)
+    {
+        ++lifecycleCounters().allocations;
+        return ::operator new(size);
+    }
+    static void operator delete(void *object) { ::operator delete(object); }
+#endif
+};
+
+// Выводит счётчики всех отслеживаемых типов; последние события (с адресами объектов,
+// которые меняются от запуска к запуску) — только при withEvents
+inline void dumpLifecycle(std::ostream &out, [[maybe_unused]] bool withEvents)
+{
+#if LIFECYCLE_TRACE >= LIFECYCLE_TRACE_COUNTERS
+    for (const LifecycleCounters *counters = LifecycleCounters::first(); counters; counters = counters->nextType)
+    {
+        out << counters->type << ": live " << counters->live << ", peak " << counters->peak << ", constructed "
+            << counters->constructed << ", copies " << counters->copies << ", moves " << counters->moves
+            << ", destroyed " << counters->destroyed << ", new " << counters->allocations << '\n';
+    }
+#if LIFECYCLE_TRACE >= LIFECYCLE_TRACE_EVENTS
+    if (withEvents)
+        LifecycleLog::instance().dump(out);
+#endif
+#else
+    out << "Lifecycle tracing is compiled out\n";
+#endif
+}
+
+
+// "Name: <имя>, HP: ..., Attack: ..., Defense: ..." — общий формат персонажей и монстров
+inline void displayStats(std::string_view name, int health, int attack, int defense)
+{
+    TextBuffer &out = TextBuffer::local();
+    out << "Name: " << name << ", HP: " << health << ", Attack: " << attack << ", Defense: " << defense << '\n';
+    out.writeTo(std::cout);
+}
+
+class Character : public Traced<Character> {
 private:
     std::string name;
     int health;
@@ -9,24 +209,36 @@ private:
     int defense;
 
 public:
-    // Конструктор
-    Character(const std::string& n, int h, int a, int d)
-        : name(n), health(h), attack(a), defense(d) {
-        std::cout << "Character " << name << " created!\n";
+    static constexpr const char* lifecycleName = "Character";
+
+    // Конструктор: имя принимается по значению и перемещается в поле
+    Character(std::string n, int h, int a, int d)
+        : name(std::move(n)), health(h), attack(a), defense(d) {
+        LIFECYCLE_PRINT("Character " << name << " created!");
     }
 
+    // Пользовательский деструктор отключает неявное перемещение, поэтому оно объявлено явно
+    Character(const Character&) = default;
+    Character(Character&&) noexcept = default;
+    Character& operator=(const Character&) = default;
+    Character& operator=(Character&&) noexcept = default;
+
     // Деструктор
     ~Character() {
-        std::cout << "Character " << name << " destroyed!\n";
+        if (!name.empty()) // Перемещённый объект уже отдал имя, о нём не сообщается
+            LIFECYCLE_PRINT("Character " << name << " destroyed!");
+    }
+
+    std::string_view getName() const noexcept {
+        return name;
     }
 
     void displayInfo() const {
-        std::cout << "Name: " << name << ", HP: " << health
-                  << ", Attack: " << attack << ", Defense: " << defense << std::endl;
+        displayStats(name, health, attack, defense);
     }
 };
 
-class Monster {
+class Monster : public Traced<Monster> {
 private:
     std::string name;
     int health;
@@ -34,45 +246,129 @@ private:
     int defense;
 
 public:
-    // Конструктор
-    Monster(const std::string& n, int h, int a, int d)
-        : name(n), health(h), attack(a), defense(d) {
-        std::cout << "Monster " << name << " created!\n";
+    static constexpr const char* lifecycleName = "Monster";
+
+    // Конструктор: имя принимается по значению и перемещается в поле
+    Monster(std::string n, int h, int a, int d)
+        : name(std::move(n)), health(h), attack(a), defense(d) {
+        LIFECYCLE_PRINT("Monster " << name << " created!");
     }
 
+    // Пользовательский деструктор отключает неявное перемещение, поэтому оно объявлено явно
+    Monster(const Monster&) = default;
+    Monster(Monster&&) noexcept = default;
+    Monster& operator=(const Monster&) = default;
+    Monster& operator=(Monster&&) noexcept = default;
+
     // Деструктор
     ~Monster() {
-        std::cout << "Monster " << name << " destroyed!\n";
+        if (!name.empty()) // Перемещённый объект уже отдал имя, о нём не сообщается
+            LIFECYCLE_PRINT("Monster " << name << " destroyed!");
+    }
+
+    std::string_view getName() const noexcept {
+        return name;
     }
 
     void displayInfo() const {
-        std::cout << "Name: " << name << ", HP: " << health
-                  << ", Attack: " << attack << ", Defense: " << defense << std::endl;
+        displayStats(name, health, attack, defense);
     }
 };
 
-class Weapon{
+// Архетип оружия: характеристики задаются при компиляции
+struct WeaponArchetype
+{
+    std::string_view name;
+    int attack;
+    int weight;
+};
+
+enum WeaponId
+{
+    AK47,
+    MacheteId,
+    RPG7,
+    WeaponCount
+};
+
+constexpr WeaponArchetype weapon_table[WeaponCount] = {
+    {"AK-47", 35, 2000},
+    {"Machete", 50, 500},
+    {"RPG-7", 85, 2500},
+};
+
+constexpr bool validWeaponTable()
+{
+    for (int i = 0; i < WeaponCount; ++i)
+    {
+        // Короткие имена помещаются во встроенный буфер std::string и не требуют выделения памяти
+        if (weapon_table[i].name.empty() || weapon_table[i].name.size() > 15 ||
+            weapon_table[i].attack <= 0 || weapon_table[i].weight <= 0)
+        {
+            return false;
+        }
+        for (int j = 0; j < i; ++j)
+        {
+            if (weapon_table[j].name == weapon_table[i].name)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static_assert(validWeaponTable(), "Weapon archetypes must have unique short names and positive stats");
+
+class Weapon : public Traced<Weapon>{
 private:
     std::string name;
     int attack;
     int weight;
 public:
-    Weapon(const std::string n, int a, int w):
-    name(n),attack(a),weight(w){
-        std::cout << "New weapon with name " << name <<" created!" << std::endl;
+    static constexpr const char* lifecycleName = "Weapon";
+
+    Weapon(std::string n, int a, int w):
+    name(std::move(n)),attack(a),weight(w){
+        LIFECYCLE_PRINT("New weapon with name " << name << " created!");
     }
+    explicit Weapon(WeaponId id):
+    Weapon(std::string(weapon_table[id].name), weapon_table[id].attack, weapon_table[id].weight){}
+    Weapon(const Weapon&) = default;
+    Weapon(Weapon&&) noexcept = default;
+    Weapon& operator=(const Weapon&) = default;
+    Weapon& operator=(Weapon&&) noexcept = default;
     ~Weapon(){
-        std::cout << "Weapon with name " << name <<" was destroyed!" << std::endl;
+        if (!name.empty()) // Перемещённый объект уже отдал имя, о нём не сообщается
+            LIFECYCLE_PRINT("Weapon with name " << name << " was destroyed!");
+    }
+    std::string_view getName() const noexcept{
+        return name;
     }
     void displayInfo() const{
-        std::cout<<"Name: "<<name<<", Damage: "<<attack<<", Weight: "<<weight<<std::endl;
+        TextBuffer &out = TextBuffer::local();
+        out << "Name: " << name << ", Damage: " << attack << ", Weight: " << weight << '\n';
+        out.writeTo(std::cout);
     }
 };
-int main()
+
+static_assert(std::is_nothrow_move_constructible<Weapon>::value && std::is_nothrow_move_assignable<Weapon>::value,
+              "Containers must move weapons instead of copying them");
+
+// Запуск: 2_0 [--trace-events]
+int main(int argc, char *argv[])
 {
-    Weapon AK ("AK-47",35,2000);
-    Weapon Machete ("Machete",50,500);
-    AK.displayInfo();
-    Machete.displayInfo();
+    bool traceEvents = argc > 1 && std::string_view(argv[1]) == "--trace-events";
+    {
+        Weapon AK (AK47);
+        Weapon Machete (MacheteId);
+        AK.displayInfo();
+        Machete.displayInfo();
+        // Список инициализации копируется в вектор: счётчики покажут лишние копии
+        std::vector<Weapon> arsenal = {AK, Machete};
+        // Перемещение при росте вектора: noexcept позволяет не копировать элементы
+        arsenal.emplace_back(RPG7);
+    }
+    dumpLifecycle(std::cout, traceEvents);
     return 0;
 }
@@ -1,5 +1,196 @@
 #include <iostream>
 #include <string>
+#include <type_traits>
+#include <string_view>
+#include <array>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include "../common/Text_buffer.h"
+
+// Трассировка жизненного цикла. Уровень выбирается при компиляции: -DLIFECYCLE_TRACE=<уровень>.
+// По умолчанию LIFECYCLE_TRACE_CONSOLE: лабораторная печатает сообщения, как и раньше.
+// При LIFECYCLE_TRACE_OFF база Traced пуста и в конструкторы не попадает ни одной инструкции
+#define LIFECYCLE_TRACE_OFF 0
+#define LIFECYCLE_TRACE_COUNTERS 1 // Счётчики по типам: живые объекты, создания, копии, перемещения, new
+#define LIFECYCLE_TRACE_EVENTS 2   // Плюс последние события в кольцевом буфере
+#define LIFECYCLE_TRACE_CONSOLE 3  // Плюс печать "created!"/"destroyed!" в std::cout, как раньше
+#ifndef LIFECYCLE_TRACE
+#define LIFECYCLE_TRACE LIFECYCLE_TRACE_CONSOLE
+#endif
+
+#if LIFECYCLE_TRACE >= LIFECYCLE_TRACE_CONSOLE
+#define LIFECYCLE_PRINT(message) (std::cout << message << std::endl)
+#else
+#define LIFECYCLE_PRINT(message) ((void)0)
+#endif
+
+enum class LifecycleEvent : uint8_t
+{
+    Created,
+    Copied,
+    Moved,
+    CopyAssigned,
+    MoveAssigned,
+    Destroyed
+};
+
+// Счётчики одного типа; все типы связаны в список для вывода. Программа однопоточная, атомики не нужны
+struct LifecycleCounters
+{
+    const char *type;
+    size_t live = 0;
+    size_t peak = 0;
+    size_t constructed = 0;
+    size_t copies = 0;
+    size_t moves = 0;
+    size_t destroyed = 0;
+    size_t allocations = 0; // Объекты, созданные через new
+    LifecycleCounters *nextType;
+
+    explicit LifecycleCounters(const char *type) : type(type), nextType(first())
+    {
+        first() = this;
+    }
+    static LifecycleCounters *&first()
+    {
+        static LifecycleCounters *head = nullptr;
+        return head;
+    }
+};
+
+// Последние capacity событий; запись не выделяет память, старые события перезаписываются
+class LifecycleLog
+{
+private:
+    struct Record
+    {
+        uint64_t sequence;
+        const char *type;
+        const void *object;
+        LifecycleEvent event;
+    };
+    static constexpr size_t capacity = 256;
+    std::array<Record, capacity> records{};
+    uint64_t next = 0;
+
+public:
+    static LifecycleLog &instance()
+    {
+        static LifecycleLog log;
+        return log;
+    }
+
+    void record(const char *type, const void *object, LifecycleEvent event)
+    {
+        records[next % capacity] = Record{next, type, object, event};
+        ++next;
+    }
+
+    void dump(std::ostream &out) const
+    {
+        static const char *const names[] = {"created", "copied", "moved", "copy-assigned", "move-assigned",
+                                            "destroyed"};
+        uint64_t begin = next > capacity ? next - capacity : 0;
+        out << "Last " << next - begin << " of " << next << " lifecycle events:\n";
+        for (uint64_t i = begin; i < next; ++i)
+        {
+            const Record &record = records[i % capacity];
+            out << "  #" << record.sequence << ' ' << record.type << ' ' << record.object << ' '
+                << names[static_cast<int>(record.event)] << '\n';
+        }
+    }
+};
+
+// База для отслеживаемых типов: T объявляет static constexpr const char *lifecycleName.
+// Копирование и перемещение T проходят через конструкторы базы и поэтому тоже учитываются
+template <typename T>
+class Traced
+{
+#if LIFECYCLE_TRACE >= LIFECYCLE_TRACE_COUNTERS
+private:
+    void note(LifecycleEvent event) const
+    {
+        LifecycleCounters &counters = lifecycleCounters();
+        switch (event)
+        {
+        case LifecycleEvent::Copied:
+        case LifecycleEvent::CopyAssigned:
+            ++counters.copies;
+            break;
+        case LifecycleEvent::Moved:
+        case LifecycleEvent::MoveAssigned:
+            ++counters.moves;
+            break;
+        default:
+            break;
+        }
+        if (event == LifecycleEvent::Created || event == LifecycleEvent::Copied || event == LifecycleEvent::Moved)
+        {
+            ++counters.constructed;
+            counters.peak = std::max(counters.peak, ++counters.live);
+        }
+        else if (event == LifecycleEvent::Destroyed)
+        {
+            ++counters.destroyed;
+            --counters.live;
+        }
+#if LIFECYCLE_TRACE >= LIFECYCLE_TRACE_EVENTS
+        LifecycleLog::instance().record(T::lifecycleName, this, event);
+#endif
+    }
+
+protected:
+    Traced() { note(LifecycleEvent::Created); }
+    Traced(const Traced &) { note(LifecycleEvent::Copied); }
+    Traced(Traced &&) noexcept { note(LifecycleEvent::Moved); }
+    Traced &operator=(const Traced &)
+    {
+        note(LifecycleEvent::CopyAssigned);
+        return *this;
+    }
+    Traced &operator=(Traced &&) noexcept
+    {
+        note(LifecycleEvent::MoveAssigned);
+        return *this;
+    }
+    ~Traced() { note(LifecycleEvent::Destroyed); }
+
+public:
+    static LifecycleCounters &lifecycleCounters()
+    {
+        static LifecycleCounters counters(T::lifecycleName);
+        return counters;
+    }
+    static void *operator new(size_t size)
+    {
+        ++lifecycleCounters().allocations;
+        return ::operator new(size);
+    }
+    static void operator delete(void *object) { ::operator delete(object); }
+#endif
+};
+
+// Выводит счётчики всех отслеживаемых типов; последние события (с адресами объектов,
+// которые меняются от запуска к запуску) — только при withEvents
+inline void dumpLifecycle(std::ostream &out, [[maybe_unused]] bool withEvents)
+{
+#if LIFECYCLE_TRACE >= LIFECYCLE_TRACE_COUNTERS
+    for (const LifecycleCounters *counters = LifecycleCounters::first(); counters; counters = counters->nextType)
+    {
+        out << counters->type << ": live " << counters->live << ", peak " << counters->peak << ", constructed "
+            << counters->constructed << ", copies " << counters->copies << ", moves " << counters->moves
+            << ", destroyed " << counters->destroyed << ", new " << counters->allocations << '\n';
+    }
+#if LIFECYCLE_TRACE >= LIFECYCLE_TRACE_EVENTS
+    if (withEvents)
+        LifecycleLog::instance().dump(out);
+#endif
+#else
+    out << "Lifecycle tracing is compiled out\n";
+#endif
+}
+
 
 class Character
 {
@@ -10,24 +201,109 @@ private:
     int defense;
 
 public:
-    Character(const std::string &n, int h, int a, int d)
-        : name(n), health(h), attack(a), defense(d) {}
+    Character(std::string n, int h, int a, int d)
+        : name(std::move(n)), health(h), attack(a), defense(d) {}
 
-    // Перегрузка оператора ==
-    bool operator==(const Character &other) const
+    std::string_view getName() const noexcept { return name; }
+
+    // Перегрузка оператора ==: сначала дешёвое сравнение чисел, строки — только если оно прошло
+    bool operator==(const Character &other) const noexcept
     {
-        return name == other.name && health == other.health;
+        return health == other.health && name == other.name;
     }
 
-    // Перегрузка оператора <<
+    // Перегрузка оператора <<: строка собирается в буфере потока и выводится одним write
     friend std::ostream &operator<<(std::ostream &os, const Character &character)
     {
-        os << "Character: " << character.name << ", HP: " << character.health
-           << ", Attack: " << character.attack << ", Defense: " << character.defense;
+        TextBuffer &out = TextBuffer::local();
+        out << "Character: " << character.name << ", HP: " << character.health << ", Attack: " << character.attack
+            << ", Defense: " << character.defense;
+        out.writeTo(os);
         return os;
     }
 };
-class Weapon
+// Архетип оружия: характеристики задаются при компиляции
+struct WeaponArchetype
+{
+    std::string_view name;
+    int attack;
+    int weight;
+};
+
+enum WeaponId
+{
+    AK47,
+    MacheteId,
+    RPG7,
+    WeaponCount
+};
+
+constexpr WeaponArchetype weapon_table[WeaponCount] = {
+    {"AK-47", 35, 2000},
+    {"Machete", 50, 500},
+    {"RPG-7", 85, 2500},
+};
+
+constexpr bool validWeaponTable()
+{
+    for (int i = 0; i < WeaponCount; ++i)
+    {
+        // Короткие имена помещаются во встроенный буфер std::string и не требуют выделения памяти
+        if (weapon_table[i].name.empty() || weapon_table[i].name.size() > 15 ||
+            weapon_table[i].attack <= 0 || weapon_table[i].weight <= 0)
+        {
+            return false;
+        }
+        for (int j = 0; j < i; ++j)
+        {
+            if (weapon_table[j].name == weapon_table[i].name)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static_assert(validWeaponTable(), "Weapon archetypes must have unique short names and positive stats");
+// Урон на килограмм веса в тысячных долях, посчитан при компиляции
+constexpr int attackPerKg(const WeaponArchetype &weapon)
+{
+    return weapon.attack * 1000 * 1000 / weapon.weight;
+}
+
+// Границы баланса: урон одного оружия от 1 до 100, вес от 100 г до 5 кг
+constexpr bool weaponStatsInRange()
+{
+    for (int i = 0; i < WeaponCount; ++i)
+    {
+        if (weapon_table[i].attack > 100 || weapon_table[i].weight < 100 || weapon_table[i].weight > 5000)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(weaponStatsInRange(), "Weapon attack must be within 1..100 and weight within 100..5000 g");
+static_assert(attackPerKg(weapon_table[MacheteId]) > attackPerKg(weapon_table[AK47]),
+              "Melee weapons must be lighter for their damage than firearms");
+
+template <typename L, typename R>
+class WeaponFusion;
+
+// Общая база для оружия и выражений его слияния, на неё опирается operator+
+template <typename Derived>
+class WeaponExpr
+{
+public:
+    const Derived &self() const
+    {
+        return static_cast<const Derived &>(*this);
+    }
+};
+
+class Weapon : public WeaponExpr<Weapon>, public Traced<Weapon>
 {
 private:
     std::string name;
@@ -35,63 +311,128 @@ private:
     int weight;
 
 public:
-    Weapon(const std::string n, int a, int w) : name(n), attack(a), weight(w)
+    static constexpr const char *lifecycleName = "Weapon";
+
+    Weapon(std::string n, int a, int w) : name(std::move(n)), attack(a), weight(w)
     {
-        std::cout << "New weapon with name " << name << " created!" << std::endl;
+        LIFECYCLE_PRINT("New weapon with name " << name << " created!");
     }
+    explicit Weapon(WeaponId id)
+        : Weapon(std::string(weapon_table[id].name), weapon_table[id].attack, weapon_table[id].weight) {}
+    // Материализация цепочки a + b + ... + n: одно оружие и одно выделение памяти под имя
+    template <typename L, typename R>
+    Weapon(const WeaponFusion<L, R> &fusion);
+    Weapon(const Weapon &) = default;
+    Weapon(Weapon &&) noexcept = default;
+    Weapon &operator=(const Weapon &) = default;
+    Weapon &operator=(Weapon &&) noexcept = default;
     ~Weapon()
     {
-        std::cout << "Weapon with name " << name << " was destroyed!" << std::endl;
+        if (!name.empty()) // Перемещённый объект уже отдал имя, о нём не сообщается
+            LIFECYCLE_PRINT("Weapon with name " << name << " was destroyed!");
     }
+    // Строка собирается в буфере потока и выводится одним write, как в operator<< персонажа
     void displayInfo() const
     {
-        std::cout << "Name: " << name << ", Damage: " << attack << ", Weight: " << weight << std::endl;
-    }
-    Weapon operator+(const Weapon& other) const{
-        std::string newName = this->name + " + " + other.name;
-        int attack = this->attack + other.attack;
-        int weight = this->weight + other.weight;
-        return Weapon(newName, attack, weight);
+        TextBuffer &out = TextBuffer::local();
+        out << "Name: " << name << ", Damage: " << attack << ", Weight: " << weight << '\n';
+        out.writeTo(std::cout);
     }
     bool operator>(const Weapon& other) const{
         return attack == other.attack;
     }
-    std::string getName() const{
+    std::string_view getName() const noexcept{
         return name;
     }
+    int getAttack() const { return attack; }
+    int getWeight() const { return weight; }
+    size_t fusedNameLength() const { return name.size(); }
+    void appendFusedName(std::string &out) const { out += name; }
 };
-int main()
+
+static_assert(std::is_nothrow_move_constructible<Weapon>::value && std::is_nothrow_move_assignable<Weapon>::value,
+              "Containers must move weapons instead of copying them");
+
+// Ленивое слияние: хранит только ссылки на исходное оружие, ничего не создаёт и не печатает.
+// Промежуточные слияния хранятся по значению, чтобы не ссылаться на временные объекты
+template <typename L, typename R>
+class WeaponFusion : public WeaponExpr<WeaponFusion<L, R>>
 {
-    Character hero1("Hero", 100, 20, 10);
-    Character hero2("Hero", 100, 20, 10);
-    Character hero3("Warrior", 150, 25, 15);
-    Weapon AK ("AK-47",35,2000);
-    Weapon Machete ("Machete",50,500);
-    Weapon RPG ("RPG-7",85,2500);
-    if (hero1 == hero2)
-    {
-        std::cout << "Hero1 and Hero2 are the same!\n";
-    }
-    if (!(hero1 == hero3))
-    {
-        std::cout << "Hero1 and Hero3 are different!\n";
-    }
-    std::cout << hero1 << std::endl; // Вывод информации о персонаже
-    Weapon HandmadeWeapon = AK+Machete;
-    HandmadeWeapon.displayInfo();
-    if (HandmadeWeapon > AK)
+private:
+    template <typename E>
+    using Stored = typename std::conditional<std::is_same<E, Weapon>::value, const Weapon &, const E>::type;
+
+    Stored<L> left;
+    Stored<R> right;
+
+public:
+    WeaponFusion(const L &left, const R &right) : left(left), right(right) {}
+
+    int getAttack() const { return left.getAttack() + right.getAttack(); }
+    int getWeight() const { return left.getWeight() + right.getWeight(); }
+    size_t fusedNameLength() const { return left.fusedNameLength() + 3 + right.fusedNameLength(); }
+    void appendFusedName(std::string &out) const
     {
-        std::cout<<"Damage of " <<HandmadeWeapon.getName() << " and " << AK.getName() << " are the same!\n";
+        left.appendFusedName(out);
+        out += " + ";
+        right.appendFusedName(out);
     }
-    else{
-        std::cout<<"Damage of " <<HandmadeWeapon.getName() << " and " << AK.getName() << " are different!\n";
-    }
-    if (HandmadeWeapon > RPG)
+};
+
+template <typename L, typename R>
+WeaponFusion<L, R> operator+(const WeaponExpr<L> &left, const WeaponExpr<R> &right)
+{
+    return WeaponFusion<L, R>(left.self(), right.self());
+}
+
+template <typename L, typename R>
+Weapon::Weapon(const WeaponFusion<L, R> &fusion) : attack(fusion.getAttack()), weight(fusion.getWeight())
+{
+    name.reserve(fusion.fusedNameLength());
+    fusion.appendFusedName(name);
+    LIFECYCLE_PRINT("New weapon with name " << name << " created!");
+}
+
+// Запуск: 3_0 [--trace-events]
+int main(int argc, char *argv[])
+{
+    bool traceEvents = argc > 1 && std::string_view(argv[1]) == "--trace-events";
+    // Объекты живут в блоке, чтобы счётчики после него показали, все ли они уничтожены
     {
-        std::cout<<"Damage of " <<HandmadeWeapon.getName() << " and " << RPG.getName() << " are the same!\n";
-    }
-    else{
-        std::cout<<"Damage of " <<HandmadeWeapon.getName() << " and " << RPG.getName() << " are different!\n";
+        Character hero1("Hero", 100, 20, 10);
+        Character hero2("Hero", 100, 20, 10);
+        Character hero3("Warrior", 150, 25, 15);
+        Weapon AK (AK47);
+        Weapon Machete (MacheteId);
+        Weapon RPG (RPG7);
+        if (hero1 == hero2)
+        {
+            std::cout << "Hero1 and Hero2 are the same!\n";
+        }
+        if (!(hero1 == hero3))
+        {
+            std::cout << "Hero1 and Hero3 are different!\n";
+        }
+        std::cout << hero1 << std::endl; // Вывод информации о персонаже
+        Weapon HandmadeWeapon = AK+Machete;
+        HandmadeWeapon.displayInfo();
+        Weapon Arsenal = AK + Machete + RPG;
+        Arsenal.displayInfo();
+        if (HandmadeWeapon > AK)
+        {
+            std::cout<<"Damage of " <<HandmadeWeapon.getName() << " and " << AK.getName() << " are the same!\n";
+        }
+        else{
+            std::cout<<"Damage of " <<HandmadeWeapon.getName() << " and " << AK.getName() << " are different!\n";
+        }
+        if (HandmadeWeapon > RPG)
+        {
+            std::cout<<"Damage of " <<HandmadeWeapon.getName() << " and " << RPG.getName() << " are the same!\n";
+        }
+        else{
+            std::cout<<"Damage of " <<HandmadeWeapon.getName() << " and " << RPG.getName() << " are different!\n";
+        }
     }
+    dumpLifecycle(std::cout, traceEvents);
     return 0;
 }
@@ -1,19 +1,457 @@
 #include <memory>
 #include <string>
 #include <iostream>
+#include <utility>
+#include <type_traits>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+// Инвентарь: первые N предметов хранятся внутри объекта, остальные — в памяти от аллокатора
+template <typename T, size_t N = 4, typename Allocator = std::allocator<T>>
 class Inventory {
+    private:
+        using Traits = std::allocator_traits<Allocator>;
+        static constexpr size_t inlineCapacity = N > 0 ? N : 1;
+
+        Allocator allocator;
+        alignas(T) unsigned char inlineStorage[inlineCapacity * sizeof(T)];
+        T* items;
+        size_t capacity;
+        size_t currentSize;
+
+        T* inlineItems() {
+            return reinterpret_cast<T*>(inlineStorage);
+        }
+        bool isInline() const {
+            return items == reinterpret_cast<const T*>(inlineStorage);
+        }
+
+        void destroyItems() {
+            for (size_t i = 0; i < currentSize; i++) {
+                Traits::destroy(allocator, items + i);
+            }
+            currentSize = 0;
+        }
+        void releaseBuffer() {
+            if (!isInline()) {
+                Traits::deallocate(allocator, items, capacity);
+            }
+            items = inlineItems();
+            capacity = inlineCapacity;
+        }
+
+        // Переносит предметы в буфер newItems (move, если он не бросает исключений, иначе копия).
+        // При исключении уже перенесённые копии уничтожаются, исходный буфер не меняется
+        void relocateTo(T* newItems) {
+            size_t moved = 0;
+            try {
+                for (; moved < currentSize; moved++) {
+                    Traits::construct(allocator, newItems + moved, std::move_if_noexcept(items[moved]));
+                }
+            } catch (...) {
+                for (size_t i = 0; i < moved; i++) {
+                    Traits::destroy(allocator, newItems + i);
+                }
+                throw;
+            }
+        }
+
+        void reallocate(size_t newCapacity) {
+            T* newItems = Traits::allocate(allocator, newCapacity);
+            try {
+                relocateTo(newItems);
+            } catch (...) {
+                Traits::deallocate(allocator, newItems, newCapacity);
+                throw;
+            }
+            size_t count = currentSize;
+            destroyItems();
+            releaseBuffer();
+            items = newItems;
+            capacity = newCapacity;
+            currentSize = count;
+        }
+
+        // Рост: новый предмет создаётся в новом буфере до переноса старых,
+        // поэтому addItem(items[0]) безопасен
+        template <typename... Args>
+        T& growAndEmplace(Args&&... args) {
+            size_t newCapacity = capacity * 2;
+            T* newItems = Traits::allocate(allocator, newCapacity);
+            try {
+                Traits::construct(allocator, newItems + currentSize, std::forward<Args>(args)...);
+                try {
+                    relocateTo(newItems);
+                } catch (...) {
+                    Traits::destroy(allocator, newItems + currentSize);
+                    throw;
+                }
+            } catch (...) {
+                Traits::deallocate(allocator, newItems, newCapacity);
+                throw;
+            }
+            size_t count = currentSize;
+            destroyItems();
+            releaseBuffer();
+            items = newItems;
+            capacity = newCapacity;
+            currentSize = count + 1;
+            return items[count];
+        }
+
+        // Переносит предметы из other в пустой инвентарь; other остаётся пустым.
+        // Чужой буфер можно забрать, только если его освободит наш аллокатор
+        void takeFrom(Inventory& other, bool canSteal) {
+            if (!other.isInline() && canSteal) {
+                items = other.items;
+                capacity = other.capacity;
+                currentSize = other.currentSize;
+                other.items = other.inlineItems();
+                other.capacity = inlineCapacity;
+                other.currentSize = 0;
+                return;
+            }
+            reserve(other.currentSize);
+            for (size_t i = 0; i < other.currentSize; i++) {
+                Traits::construct(allocator, items + i, std::move(other.items[i]));
+                currentSize++;
+            }
+            other.destroyItems();
+            other.releaseBuffer();
+        }
+
+    public:
+        explicit Inventory(size_t initialCapacity = 0, const Allocator& alloc = Allocator())
+            : allocator(alloc), items(inlineItems()), capacity(inlineCapacity), currentSize(0) {
+            reserve(initialCapacity);
+        }
+
+        Inventory(const Inventory& other)
+            : allocator(Traits::select_on_container_copy_construction(other.allocator)),
+              items(inlineItems()), capacity(inlineCapacity), currentSize(0) {
+            reserve(other.currentSize);
+            for (size_t i = 0; i < other.currentSize; i++) {
+                emplaceItem(other.items[i]);
+            }
+        }
+
+        Inventory(Inventory&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
+            : allocator(std::move(other.allocator)), items(inlineItems()), capacity(inlineCapacity), currentSize(0) {
+            takeFrom(other, true);
+        }
+
+        Inventory& operator=(const Inventory& other) {
+            if (this != &other) {
+                Inventory copy(other);
+                destroyItems();
+                releaseBuffer();
+                if (Traits::propagate_on_container_copy_assignment::value) {
+                    allocator = other.allocator;
+                }
+                takeFrom(copy, allocator == copy.allocator);
+            }
+            return *this;
+        }
+
+        Inventory& operator=(Inventory&& other) {
+            if (this != &other) {
+                destroyItems();
+                releaseBuffer();
+                if (Traits::propagate_on_container_move_assignment::value) {
+                    allocator = std::move(other.allocator);
+                }
+                takeFrom(other, allocator == other.allocator);
+            }
+            return *this;
+        }
+
+        ~Inventory() {
+            destroyItems();
+            releaseBuffer();
+        }
+
+        void addItem(const T& item) {
+            emplaceItem(item);
+        }
+        void addItem(T&& item) {
+            emplaceItem(std::move(item));
+        }
+
+        template <typename... Args>
+        T& emplaceItem(Args&&... args) {
+            if (currentSize == capacity) {
+                return growAndEmplace(std::forward<Args>(args)...);
+            }
+            Traits::construct(allocator, items + currentSize, std::forward<Args>(args)...);
+            return items[currentSize++];
+        }
+
+        void reserve(size_t newCapacity) {
+            if (newCapacity > capacity) {
+                reallocate(newCapacity);
+            }
+        }
+
+        // Возвращает лишнюю память; небольшой инвентарь возвращается во встроенный буфер
+        void shrinkToFit() {
+            if (isInline() || currentSize == capacity) {
+                return;
+            }
+            if (currentSize > inlineCapacity) {
+                reallocate(currentSize);
+                return;
+            }
+            T* heapItems = items;
+            size_t heapCapacity = capacity;
+            size_t count = currentSize;
+            items = inlineItems();
+            currentSize = 0;
+            try {
+                for (; currentSize < count; currentSize++) {
+                    Traits::construct(allocator, items + currentSize, std::move_if_noexcept(heapItems[currentSize]));
+                }
+            } catch (...) {
+                destroyItems();
+                items = heapItems;
+                capacity = heapCapacity;
+                currentSize = count;
+                throw;
+            }
+            for (size_t i = 0; i < count; i++) {
+                Traits::destroy(allocator, heapItems + i);
+            }
+            Traits::deallocate(allocator, heapItems, heapCapacity);
+            capacity = inlineCapacity;
+        }
+
+        size_t size() const {
+            return currentSize;
+        }
+        size_t getCapacity() const {
+            return capacity;
+        }
+        const T& operator[](size_t index) const {
+            return items[index];
+        }
+
+        void displayInventory() const {
+            if (currentSize == 0) {
+                std::cout << "Inventory is empty\n";
+                return;
+            }
+            std::cout << "Inventory contents:\n";
+            for (size_t i = 0; i < currentSize; i++) {
+                std::cout << i + 1 << ". " << items[i] << "\n";
+            }
+        }
+    };
+// Постоянный (persistent) инвентарь: каждое изменение создаёт новую версию, копируя
+// только путь от корня до листа, остальные узлы общие. Снимок — это копия корня, O(1).
+// Дерево разбито по 5 бит ключа; ключи выдаются по возрастанию, поэтому порядок предметов
+// сохраняется, а удалённые ключи остаются дырами, которые сжимает битовая маска узла
+template <typename T, typename Allocator = std::allocator<T>>
+class PersistentInventory {
+    private:
+        static constexpr unsigned bits = 5;
+        static constexpr uint32_t width = 1u << bits;
+
+        struct Node;
+        using ChildAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<std::shared_ptr<Node>>;
+
+        // Узлы и их массивы берут память у аллокатора инвентаря
+        struct Node {
+            uint32_t bitmap = 0; // Какие из width позиций заняты
+            size_t count = 0;    // Предметов в поддереве
+            std::vector<std::shared_ptr<Node>, ChildAllocator> children; // Внутренний узел
+            std::vector<T, Allocator> values;                            // Лист
+
+            explicit Node(const Allocator& alloc) : children(ChildAllocator(alloc)), values(alloc) {}
+        };
+
+        Allocator allocator;
+        std::shared_ptr<Node> root;
+        unsigned shift = 0; // Сдвиг ключа на уровне корня; у листьев 0
+        uint64_t nextKey = 0;
+
+        static unsigned popcount(uint32_t value) {
+            value = value - ((value >> 1) & 0x55555555u);
+            value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+            return (((value + (value >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+        }
+
+        // Снимает бит, соответствующий n-й занятой позиции
+        static uint32_t clearNthBit(uint32_t bitmap, size_t n) {
+            uint32_t rest = bitmap;
+            for (size_t i = 0; i < n; i++) {
+                rest &= rest - 1;
+            }
+            return bitmap & ~(rest & (~rest + 1));
+        }
+
+        // Узел можно менять на месте, только если им не владеет ни одна другая версия
+        Node& editable(std::shared_ptr<Node>& node) {
+            if (!node) {
+                node = std::allocate_shared<Node>(allocator, allocator);
+            } else if (node.use_count() > 1) {
+                node = std::allocate_shared<Node>(allocator, *node);
+            }
+            return *node;
+        }
+
+        template <typename U>
+        void insert(std::shared_ptr<Node>& node, unsigned level, uint64_t key, U&& value) {
+            Node& own = editable(node);
+            uint32_t bit = 1u << ((key >> level) & (width - 1));
+            size_t pos = popcount(own.bitmap & (bit - 1));
+            own.count++;
+            if (level == 0) {
+                own.values.insert(own.values.begin() + pos, std::forward<U>(value));
+                own.bitmap |= bit;
+                return;
+            }
+            if (!(own.bitmap & bit)) {
+                own.children.insert(own.children.begin() + pos, nullptr);
+                own.bitmap |= bit;
+            }
+            insert(own.children[pos], level - bits, key, std::forward<U>(value));
+        }
+
+        void removeAt(std::shared_ptr<Node>& node, unsigned level, size_t index) {
+            Node& own = editable(node);
+            own.count--;
+            if (level == 0) {
+                own.values.erase(own.values.begin() + index);
+                own.bitmap = clearNthBit(own.bitmap, index);
+                return;
+            }
+            size_t pos = 0;
+            while (index >= own.children[pos]->count) {
+                index -= own.children[pos]->count;
+                pos++;
+            }
+            removeAt(own.children[pos], level - bits, index);
+            if (own.children[pos]->count == 0) {
+                own.children.erase(own.children.begin() + pos);
+                own.bitmap = clearNthBit(own.bitmap, pos);
+            }
+        }
+
+        template <typename Function>
+        static void visit(const Node& node, unsigned level, Function& function) {
+            if (level == 0) {
+                for (const T& value : node.values) {
+                    function(value);
+                }
+                return;
+            }
+            for (const auto& child : node.children) {
+                visit(*child, level - bits, function);
+            }
+        }
+
+        template <typename U>
+        void append(U&& value) {
+            uint64_t key = nextKey++;
+            // Ключ не помещается в дерево: старый корень становится первым ребёнком нового
+            while ((key >> shift) >= width) {
+                if (root) {
+                    auto grown = std::allocate_shared<Node>(allocator, allocator);
+                    grown->bitmap = 1;
+                    grown->count = root->count;
+                    grown->children.push_back(std::move(root));
+                    root = std::move(grown);
+                }
+                shift += bits;
+            }
+            insert(root, shift, key, std::forward<U>(value));
+        }
+
+    public:
+        explicit PersistentInventory(const Allocator& alloc = Allocator()) : allocator(alloc) {}
+
+        void addItem(const T& item) {
+            append(item);
+        }
+        void addItem(T&& item) {
+            append(std::move(item));
+        }
+
+        void removeItem(size_t index) {
+            if (index >= size()) {
+                throw std::out_of_range("Invalid item index");
+            }
+            removeAt(root, shift, index);
+            if (root->count == 0) {
+                root.reset();
+            }
+        }
+
+        const T& operator[](size_t index) const {
+            if (index >= size()) {
+                throw std::out_of_range("Invalid item index");
+            }
+            const Node* node = root.get();
+            for (unsigned level = shift; level > 0; level -= bits) {
+                size_t pos = 0;
+                while (index >= node->children[pos]->count) {
+                    index -= node->children[pos]->count;
+                    pos++;
+                }
+                node = node->children[pos].get();
+            }
+            return node->values[index];
+        }
+
+        size_t size() const {
+            return root ? root->count : 0;
+        }
+
+        // Неизменяемая версия, разделяющая все узлы с текущей
+        PersistentInventory snapshot() const {
+            return *this;
+        }
+
+        template <typename Function>
+        void forEach(Function function) const {
+            if (root) {
+                visit(*root, shift, function);
+            }
+        }
+
+        void displayInventory() const {
+            if (size() == 0) {
+                std::cout << "Inventory is empty\n";
+                return;
+            }
+            std::cout << "Inventory contents:\n";
+            size_t number = 1;
+            forEach([&number](const T& item) {
+                std::cout << number++ << ". " << item << "\n";
+            });
+        }
+    };
+// Прежний инвентарь для сравнения: массив std::string из new[], при росте вдвое элементы
+// переносятся в новый массив. Копирование запрещено (прежний класс освобождал бы массив дважды)
+class LegacyInventory {
     private:
         std::string* items;
         size_t capacity;
         size_t currentSize;
-    
+
     public:
-        Inventory(size_t initialCapacity = 10) 
+        LegacyInventory(size_t initialCapacity = 10)
             : capacity(initialCapacity), currentSize(0) {
             items = new std::string[capacity];
         }
+        LegacyInventory(const LegacyInventory&) = delete;
+        LegacyInventory& operator=(const LegacyInventory&) = delete;
 
-        ~Inventory() {
+        ~LegacyInventory() {
             delete[] items;
         }
 
@@ -36,21 +474,214 @@ class Inventory {
                 capacity = newCapacity;
             }
         }
-        void displayInventory() const {
-            if (currentSize == 0) {
-                std::cout << "Inventory is empty\n";
-                return;
-            }
-            std::cout << "Inventory contents:\n";
-            for (size_t i = 0; i < currentSize; i++) {
-                std::cout << i + 1 << ". " << items[i] << "\n";
-            }
+        size_t size() const {
+            return currentSize;
+        }
+    };
+
+template <typename Container>
+void putItem(Container& inventory, const std::string& item) {
+    inventory.addItem(item);
+}
+void putItem(std::vector<std::string>& inventory, const std::string& item) {
+    inventory.push_back(item);
+}
+
+// Время создания count инвентарей по 3 предмета вместе с их уничтожением
+template <typename Container>
+double fillSmallInventories(size_t count, const std::string (&names)[3], size_t& checksum) {
+    auto started = std::chrono::steady_clock::now();
+    std::unique_ptr<Container[]> inventories(new Container[count]);
+    for (size_t i = 0; i < count; i++) {
+        for (const std::string& name : names) {
+            putItem(inventories[i], name);
         }
+    }
+    checksum += inventories[count - 1].size();
+    inventories.reset();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+}
+
+// Время заполнения одного инвентаря всеми предметами items
+template <typename Container>
+double fillLargeInventory(const std::vector<std::string>& items, size_t& checksum) {
+    auto started = std::chrono::steady_clock::now();
+    {
+        Container inventory;
+        for (const std::string& item : items) {
+            putItem(inventory, item);
+        }
+        checksum += inventory.size();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+}
+
+// Сравнение Inventory с прежним классом и std::vector: много маленьких инвентарей
+// (предметы помещаются во встроенный буфер) и один большой, растущий от пустого
+int runInventoryBenchmark(size_t count) {
+    if (count == 0) {
+        std::cerr << "Error: --bench needs at least 1 inventory" << std::endl;
+        return 2;
+    }
+    const int trials = 3;
+    const std::string names[3] = {"Sword", "Shield", "Potion"};
+    std::vector<std::string> items;
+    items.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        items.push_back("Item_" + std::to_string(i));
+    }
+
+    double smallBest[3] = {1e30, 1e30, 1e30};
+    double largeBest[3] = {1e30, 1e30, 1e30};
+    size_t checksum = 0; // Не даёт компилятору выбросить заполнение
+    for (int trial = 0; trial < trials; trial++) {
+        smallBest[0] = std::min(smallBest[0], fillSmallInventories<LegacyInventory>(count, names, checksum));
+        smallBest[1] = std::min(smallBest[1], fillSmallInventories<Inventory<std::string>>(count, names, checksum));
+        smallBest[2] = std::min(smallBest[2],
+                                fillSmallInventories<std::vector<std::string>>(count, names, checksum));
+        largeBest[0] = std::min(largeBest[0], fillLargeInventory<LegacyInventory>(items, checksum));
+        largeBest[1] = std::min(largeBest[1], fillLargeInventory<Inventory<std::string>>(items, checksum));
+        largeBest[2] = std::min(largeBest[2], fillLargeInventory<std::vector<std::string>>(items, checksum));
+    }
+
+    const char* labels[3] = {"Old Inventory", "Inventory<std::string>", "std::vector"};
+    const size_t sizes[3] = {sizeof(LegacyInventory), sizeof(Inventory<std::string>),
+                             sizeof(std::vector<std::string>)};
+    std::cout << "Inventories: " << count << ", best of " << trials << " trials\n";
+    for (int i = 0; i < 3; i++) {
+        std::cout << labels[i] << " (" << sizes[i] << " bytes): 3-item inventories " << count / smallBest[i]
+                  << "/sec, one inventory " << count / largeBest[i] << " items/sec\n";
+    }
+    std::cout << "Checksum: " << checksum << std::endl;
+    return 0;
+}
+
+// Аллокатор для замеров: ведёт в общем счётчике байты, занятые сейчас
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+    size_t* liveBytes;
+
+    explicit CountingAllocator(size_t* counter) noexcept : liveBytes(counter) {}
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& other) noexcept : liveBytes(other.liveBytes) {}
+
+    T* allocate(size_t count) {
+        T* memory = std::allocator<T>().allocate(count);
+        *liveBytes += count * sizeof(T);
+        return memory;
+    }
+    void deallocate(T* memory, size_t count) noexcept {
+        *liveBytes -= count * sizeof(T);
+        std::allocator<T>().deallocate(memory, count);
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const CountingAllocator<T>& left, const CountingAllocator<U>& right) noexcept {
+    return left.liveBytes == right.liveBytes;
+}
+template <typename T, typename U>
+bool operator!=(const CountingAllocator<T>& left, const CountingAllocator<U>& right) noexcept {
+    return !(left == right);
+}
+
+// Тысячи снимков большого постоянного инвентаря: после каждого снимка предмет удаляется
+// или добавляется, поэтому снимки расходятся и удерживают свои копии путей дерева.
+// Для сравнения — полные копии Inventory с теми же предметами. Память считают аллокаторы
+// инвентарей; имена предметов короткие и хранятся внутри std::string
+int runSnapshotBenchmark(size_t itemCount, size_t snapshotCount) {
+    if (itemCount < 2 || snapshotCount == 0) {
+        std::cerr << "Error: --snapshot-bench needs at least 2 items and 1 snapshot" << std::endl;
+        return 2;
+    }
+    const int trials = 3;
+    const size_t copyCount = std::min<size_t>(snapshotCount, 100);
+    auto seconds = [](std::chrono::steady_clock::time_point started) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
     };
-int main() {
-    std::unique_ptr<Inventory>  inventories[] = {
-        std::make_unique<Inventory>(3),
-        std::make_unique<Inventory>(2)
+
+    std::vector<std::string> items;
+    items.reserve(itemCount);
+    for (size_t i = 0; i < itemCount; i++) {
+        items.push_back("Item_" + std::to_string(i));
+    }
+    using Allocator = CountingAllocator<std::string>;
+    size_t bagHeap = 0, flatHeap = 0;
+    PersistentInventory<std::string, Allocator> bag{Allocator(&bagHeap)};
+    Inventory<std::string, 4, Allocator> flat(0, Allocator(&flatHeap));
+    for (const std::string& item : items) {
+        bag.addItem(item);
+        flat.addItem(item);
+    }
+    size_t bagBytes = bagHeap, flatBytes = flatHeap;
+
+    std::mt19937 random(42);
+    double snapshotBest = 1e30, editedBest = 1e30, copyBest = 1e30;
+    size_t editedBytes = 0, copyBytes = 0;
+    std::vector<PersistentInventory<std::string, Allocator>> snapshots;
+    std::vector<Inventory<std::string, 4, Allocator>> copies;
+    snapshots.reserve(snapshotCount);
+    copies.reserve(copyCount);
+    for (int trial = 0; trial < trials; trial++) {
+        auto started = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < snapshotCount; i++) {
+            snapshots.push_back(bag.snapshot());
+        }
+        snapshotBest = std::min(snapshotBest, seconds(started));
+        snapshots.clear();
+
+        size_t startSize = bag.size();
+        size_t heapBefore = bagHeap;
+        started = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < snapshotCount; i++) {
+            snapshots.push_back(bag.snapshot());
+            if (i % 2 == 0) {
+                bag.removeItem(random() % bag.size());
+            } else {
+                bag.addItem(items[i % itemCount]);
+            }
+        }
+        editedBest = std::min(editedBest, seconds(started));
+        editedBytes = bagHeap - heapBefore;
+        if (snapshots[0].size() != startSize || (snapshotCount > 1 && snapshots[1].size() != startSize - 1)) {
+            std::cerr << "Error: snapshots changed after later edits" << std::endl;
+            return 1;
+        }
+        snapshots.clear();
+
+        heapBefore = flatHeap;
+        started = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < copyCount; i++) {
+            copies.push_back(flat);
+        }
+        copyBest = std::min(copyBest, seconds(started));
+        copyBytes = flatHeap - heapBefore;
+        copies.clear();
+    }
+
+    std::cout << "Items: " << itemCount << ", snapshots: " << snapshotCount << ", full copies: " << copyCount
+              << ", best of " << trials << " trials\n";
+    std::cout << "PersistentInventory: " << bagBytes / 1024.0 / 1024.0 << " MB, snapshot "
+              << snapshotBest / snapshotCount * 1e9 << " ns, snapshot + edit " << editedBest / snapshotCount * 1e9
+              << " ns and " << editedBytes / snapshotCount << " bytes per version\n";
+    std::cout << "Inventory copy: " << flatBytes / 1024.0 / 1024.0 << " MB, copy " << copyBest / copyCount * 1e6
+              << " us and " << copyBytes / copyCount << " bytes per version\n";
+    return 0;
+}
+
+// Запуск: 4_0 [--bench [инвентарей] | --snapshot-bench [предметов] [снимков]]
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string_view(argv[1]) == "--bench") {
+        return runInventoryBenchmark(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000000);
+    }
+    if (argc > 1 && std::string_view(argv[1]) == "--snapshot-bench") {
+        return runSnapshotBenchmark(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100000,
+                                    argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 5000);
+    }
+    std::unique_ptr<Inventory<std::string>>  inventories[] = {
+        std::make_unique<Inventory<std::string>>(3),
+        std::make_unique<Inventory<std::string>>(2)
     };
     inventories[0]->addItem("Sword");
     inventories[0]->addItem("Shield");
@@ -64,5 +695,17 @@ int main() {
         inv->displayInventory();
         std::cout << "----------------\n";
     }
+
+    PersistentInventory<std::string> bag;
+    bag.addItem("Sword");
+    bag.addItem("Shield");
+    bag.addItem("Potion");
+    PersistentInventory<std::string> beforeTrade = bag.snapshot();
+    bag.removeItem(1);
+    bag.addItem("Gold");
+    std::cout << "Before trade:\n";
+    beforeTrade.displayInventory();
+    std::cout << "After trade:\n";
+    bag.displayInventory();
     return 0;
 }
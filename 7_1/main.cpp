@@ -2,7 +2,470 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <sstream>
 #include <stdexcept>
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <new>
+#include <random>
+#include <type_traits>
+#include <thread>
+#include <exception>
+#include <filesystem>
+#include <iterator>
+#include "../common/Text_buffer.h"
+
+// Запись полей сущности в сохранение. Формат (двоичный или текстовый) выбирает реализация,
+// сами сущности знают только порядок своих полей
+class RecordWriter
+{
+public:
+    virtual ~RecordWriter() {}
+    virtual void writeInt(int value) = 0;
+    virtual void writeString(const std::string &value) = 0;
+};
+
+class RecordReader
+{
+public:
+    virtual ~RecordReader() {}
+    virtual int readInt() = 0;
+    virtual std::string readString() = 0;
+};
+
+// Двоичная запись: числа в little-endian, строки с префиксом длины
+class BinaryRecordWriter : public RecordWriter
+{
+private:
+    std::string &buffer;
+
+public:
+    explicit BinaryRecordWriter(std::string &buffer) : buffer(buffer) {}
+
+    void writeU32(uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            buffer.push_back(static_cast<char>(value >> (8 * i)));
+        }
+    }
+    void writeInt(int value) override { writeU32(static_cast<uint32_t>(value)); }
+    void writeString(const std::string &value) override
+    {
+        writeU32(static_cast<uint32_t>(value.size()));
+        buffer.append(value);
+    }
+};
+
+class BinaryRecordReader : public RecordReader
+{
+private:
+    const char *data;
+    size_t size;
+    size_t pos = 0;
+
+    const char *take(size_t count)
+    {
+        if (size - pos < count)
+        {
+            throw std::runtime_error("Save record is truncated");
+        }
+        const char *result = data + pos;
+        pos += count;
+        return result;
+    }
+
+public:
+    BinaryRecordReader(const char *data, size_t size) : data(data), size(size) {}
+
+    uint32_t readU32()
+    {
+        const unsigned char *bytes = reinterpret_cast<const unsigned char *>(take(4));
+        return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    }
+    int readInt() override { return static_cast<int>(readU32()); }
+    std::string readString() override
+    {
+        uint32_t length = readU32();
+        return std::string(take(length), length);
+    }
+};
+
+// Текстовая запись: поля через табуляцию, в строках экранируются \\, \t и \n,
+// поэтому имена с пробелами и любыми символами читаются обратно без искажений
+class TextRecordWriter : public RecordWriter
+{
+private:
+    std::string &line;
+
+public:
+    explicit TextRecordWriter(std::string &line) : line(line) {}
+
+    void writeInt(int value) override
+    {
+        line += '\t';
+        line += std::to_string(value);
+    }
+    void writeString(const std::string &value) override
+    {
+        line += '\t';
+        for (char c : value)
+        {
+            switch (c)
+            {
+            case '\\': line += "\\\\"; break;
+            case '\t': line += "\\t"; break;
+            case '\n': line += "\\n"; break;
+            case '\r': line += "\\r"; break;
+            default: line += c;
+            }
+        }
+    }
+};
+
+class TextRecordReader : public RecordReader
+{
+private:
+    const std::string &line;
+    size_t pos;
+
+    // Следующее поле строки без разделителя
+    std::string nextField()
+    {
+        if (pos >= line.size() || line[pos] != '\t')
+        {
+            throw std::runtime_error("Save record has too few fields");
+        }
+        size_t begin = ++pos;
+        pos = line.find('\t', begin);
+        if (pos == std::string::npos)
+        {
+            pos = line.size();
+        }
+        return line.substr(begin, pos - begin);
+    }
+
+public:
+    // pos указывает на разделитель перед первым полем
+    TextRecordReader(const std::string &line, size_t pos) : line(line), pos(pos) {}
+
+    int readInt() override
+    {
+        std::string field = nextField();
+        size_t used = 0;
+        int value = std::stoi(field, &used);
+        if (used != field.size())
+        {
+            throw std::runtime_error("Save record has an invalid number: " + field);
+        }
+        return value;
+    }
+    std::string readString() override
+    {
+        std::string field = nextField();
+        std::string value;
+        value.reserve(field.size());
+        for (size_t i = 0; i < field.size(); ++i)
+        {
+            if (field[i] != '\\' || i + 1 == field.size())
+            {
+                value += field[i];
+                continue;
+            }
+            char c = field[++i];
+            value += c == 't' ? '\t' : c == 'n' ? '\n' : c == 'r' ? '\r' : c;
+        }
+        return value;
+    }
+};
+
+// Поколенческий дескриптор вместо сырого указателя: после удаления объекта или clear()
+// старый дескриптор перестаёт быть действительным и не может указать на чужой объект
+struct SlabHandle
+{
+    uint32_t index;
+    uint32_t generation;
+    uint32_t epoch; // Номер очистки пула: clear() обесценивает все дескрипторы сразу
+};
+
+// Пул объектов T и его наследников в слотах одинакового размера. Слоты выделяются блоками
+// и переиспользуются, поэтому создание и удаление не обращаются к системному аллокатору
+template <typename T, size_t SlotSize>
+class SlabPool
+{
+private:
+    // Учёт слота лежит в его заголовке, на одной строке кэша с началом объекта: удаление по
+    // случайному дескриптору не трогает других массивов. Отдельного списка живых объектов нет,
+    // обход идёт по слотам подряд и пропускает пустые
+    struct alignas(std::max_align_t) Slot
+    {
+        T *object = nullptr; // nullptr — слот свободен
+        uint32_t generation = 0;
+        alignas(std::max_align_t) unsigned char bytes[SlotSize];
+    };
+
+    static constexpr uint32_t blockSize = 4096;
+
+    std::vector<std::unique_ptr<Slot[]>> blocks;
+    std::vector<uint32_t> freeSlots;
+    uint32_t used = 0; // Слоты с большими номерами ещё не выдавались
+    size_t live = 0;
+    uint32_t epoch = 0;
+
+    Slot &slotAt(uint32_t index) { return blocks[index / blockSize][index % blockSize]; }
+    const Slot &slotAt(uint32_t index) const { return blocks[index / blockSize][index % blockSize]; }
+
+    // Память объектов не обнуляется: инициализируются только заголовки
+    void addBlock() { blocks.emplace_back(new Slot[blockSize]); }
+
+    uint32_t acquire()
+    {
+        if (!freeSlots.empty())
+        {
+            uint32_t index = freeSlots.back();
+            freeSlots.pop_back();
+            return index;
+        }
+        return acquireFresh();
+    }
+
+    // Редкий путь вынесен отдельно, чтобы acquire встраивался в construct
+    uint32_t acquireFresh()
+    {
+        if (used == blocks.size() * blockSize)
+        {
+            addBlock();
+        }
+        slotAt(used).object = nullptr; // После clear() в слоте мог остаться объект прошлой эпохи
+        return used++;
+    }
+
+    void destroyObject(T *object)
+    {
+        if constexpr (!std::is_trivially_destructible<T>::value)
+        {
+            object->~T();
+        }
+    }
+
+public:
+    // Обход живых объектов в порядке слотов
+    class const_iterator
+    {
+    private:
+        const SlabPool *pool;
+        uint32_t index;
+
+        void skipFree()
+        {
+            while (index < pool->used && !pool->slotAt(index).object)
+            {
+                ++index;
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T *;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T *const *;
+        using reference = T *;
+
+        const_iterator(const SlabPool *pool, uint32_t index) : pool(pool), index(index) { skipFree(); }
+
+        T *operator*() const { return pool->slotAt(index).object; }
+        const_iterator &operator++()
+        {
+            ++index;
+            skipFree();
+            return *this;
+        }
+        bool operator==(const const_iterator &other) const { return index == other.index; }
+        bool operator!=(const const_iterator &other) const { return index != other.index; }
+    };
+
+    SlabPool() = default;
+    ~SlabPool() { clear(); }
+    SlabPool(const SlabPool &) = delete;
+    SlabPool &operator=(const SlabPool &) = delete;
+
+    // Строит объект в свободном слоте; construct получает адрес памяти слота и возвращает построенный объект
+    template <typename Construct>
+    SlabHandle construct(Construct construct)
+    {
+        uint32_t index = acquire();
+        Slot &slot = slotAt(index);
+        T *object;
+        try
+        {
+            object = construct(slot.bytes);
+        }
+        catch (...)
+        {
+            freeSlots.push_back(index);
+            throw;
+        }
+        slot.object = object;
+        ++live;
+        return SlabHandle{index, slot.generation, epoch};
+    }
+
+    template <typename U, typename... Args>
+    SlabHandle emplace(Args &&...args)
+    {
+        static_assert(std::is_base_of<T, U>::value, "Pool stores only T and its subclasses");
+        static_assert(sizeof(U) <= SlotSize && alignof(U) <= alignof(Slot), "Type does not fit into a pool slot");
+        return construct([&](void *slot) -> T * { return new (slot) U(std::forward<Args>(args)...); });
+    }
+
+    bool valid(SlabHandle handle) const
+    {
+        if (handle.epoch != epoch || handle.index >= used)
+        {
+            return false;
+        }
+        const Slot &slot = slotAt(handle.index);
+        return slot.generation == handle.generation && slot.object;
+    }
+
+    T *get(SlabHandle handle) { return valid(handle) ? slotAt(handle.index).object : nullptr; }
+    const T *get(SlabHandle handle) const { return valid(handle) ? slotAt(handle.index).object : nullptr; }
+
+    bool destroy(SlabHandle handle)
+    {
+        if (!valid(handle))
+        {
+            return false;
+        }
+        Slot &slot = slotAt(handle.index);
+        destroyObject(slot.object);
+        slot.object = nullptr;
+        ++slot.generation;
+        --live;
+        freeSlots.push_back(handle.index);
+        return true;
+    }
+
+    // Старые дескрипторы отсекает смена epoch. Деструкторы вызываются только у типов, которым
+    // они нужны: у Entity есть std::string, поэтому для сущностей очистка O(n), но память
+    // слотов остаётся у пула и системному аллокатору не возвращается
+    void clear()
+    {
+        if constexpr (!std::is_trivially_destructible<T>::value)
+        {
+            for (uint32_t index = 0; index < used; ++index)
+            {
+                Slot &slot = slotAt(index);
+                if (slot.object)
+                {
+                    destroyObject(slot.object);
+                    slot.object = nullptr;
+                }
+            }
+        }
+        freeSlots.clear();
+        used = 0;
+        live = 0;
+        ++epoch;
+    }
+
+    void reserve(size_t count)
+    {
+        while (blocks.size() * blockSize < count)
+        {
+            addBlock();
+        }
+    }
+
+    // Параллельное заполнение: claim выделяет count новых слотов подряд, потоки строят объекты
+    // в своих непересекающихся слотах через constructAt, затем commit в одном потоке
+    // учитывает построенные объекты, а пустые слоты возвращает в свободные
+    uint32_t claim(size_t count)
+    {
+        uint32_t first = used;
+        reserve(used + count);
+        for (uint32_t index = first; index < first + count; ++index)
+        {
+            slotAt(index).object = nullptr;
+        }
+        used += static_cast<uint32_t>(count);
+        return first;
+    }
+
+    template <typename Construct>
+    void constructAt(uint32_t index, Construct construct)
+    {
+        Slot &slot = slotAt(index);
+        slot.object = construct(slot.bytes);
+    }
+
+    void commit(uint32_t first, size_t count)
+    {
+        for (uint32_t index = first; index < first + count; ++index)
+        {
+            if (slotAt(index).object)
+                ++live;
+            else
+                freeSlots.push_back(index);
+        }
+    }
+
+    size_t size() const { return live; }
+    // Число выданных слотов; slot(k) — обход с k-го слота, так пул делится на части без общего списка
+    size_t slotCount() const { return used; }
+    const_iterator slot(size_t index) const { return const_iterator(this, static_cast<uint32_t>(index)); }
+    const_iterator begin() const { return slot(0); }
+    const_iterator end() const { return slot(used); }
+};
+
+class Entity;
+
+// Размер памяти слота пула сущностей; подкласс, который в неё не помещается, не зарегистрируется.
+// Вместе с 16-байтным заголовком слот занимает ровно две строки кэша
+const size_t entitySlotSize = 112;
+
+// Реестр типов сущностей: тег типа из сохранения -> фабрика, строящая сущность в слоте пула
+// по полям записи. Каждый подкласс регистрируется один раз строкой EntityRegistry::add<Класс>()
+class EntityRegistry
+{
+public:
+    using Factory = Entity *(*)(void *slot, RecordReader &);
+
+private:
+    static std::unordered_map<std::string, Factory> &factories()
+    {
+        static std::unordered_map<std::string, Factory> table;
+        return table;
+    }
+
+    template <typename T>
+    static Entity *make(void *slot, RecordReader &in)
+    {
+        return new (slot) T(in);
+    }
+
+public:
+    template <typename T>
+    static bool add()
+    {
+        static_assert(sizeof(T) <= entitySlotSize, "Entity type does not fit into a pool slot");
+        return factories().emplace(T::tag(), &make<T>).second;
+    }
+
+    // nullptr для незнакомого тега: такую запись загрузчик пропускает
+    static Factory find(const std::string &tag)
+    {
+        auto it = factories().find(tag);
+        return it == factories().end() ? nullptr : it->second;
+    }
+};
 
 class Entity
 {
@@ -11,9 +474,30 @@ protected:
     int health;
     int attack;
     int defense;
+
+    // "<label><имя>, HP: ..., Attack: ..., Defense: ..."
+    void appendStats(TextBuffer &out, const char *label) const
+    {
+        out << label << name << ", HP: " << health << ", Attack: " << attack << ", Defense: " << defense;
+    }
 public:
     Entity(const std::string &n, int h, int a, int d)
         : name(n), health(h), attack(a), defense(d) {}
+    // Чтение из записи сохранения: поля идут в порядке объявления
+    explicit Entity(RecordReader &in)
+        : name(in.readString()), health(in.readInt()), attack(in.readInt()), defense(in.readInt()) {}
+
+    static const char *tag() { return "Entity"; }
+    // Тег типа в сохранении; по нему реестр находит фабрику при загрузке
+    virtual const char *typeTag() const { return tag(); }
+    // Подклассы с собственными полями дописывают их после полей базового класса
+    virtual void save(RecordWriter &out) const
+    {
+        out.writeString(name);
+        out.writeInt(health);
+        out.writeInt(attack);
+        out.writeInt(defense);
+    }
 
     // Виртуальный метод для атаки
     virtual void attackEnemy(Entity &target)
@@ -40,11 +524,16 @@ public:
 
     void takeDamage(int damage) { health -= damage; }
 
-    // Виртуальный метод для вывода информации
-    virtual void displayInfo() const
+    // Виртуальный метод, дописывающий информацию о сущности в out без перевода строки
+    virtual void appendInfo(TextBuffer &out) const { appendStats(out, "Name: "); }
+
+    // Вывод информации одним write, без сброса потока после строки
+    void displayInfo() const
     {
-        std::cout << "Name: " << name << ", HP: " << health
-                  << ", Attack: " << attack << ", Defense: " << defense << std::endl;
+        TextBuffer &out = TextBuffer::local();
+        appendInfo(out);
+        out << '\n';
+        out.writeTo(std::cout);
     }
 
     // Виртуальный деструктор
@@ -56,6 +545,10 @@ class Character : public Entity
 public:
     Character(const std::string &n, int h, int a, int d)
         : Entity(n, h, a, d) {}
+    explicit Character(RecordReader &in) : Entity(in) {}
+
+    static const char *tag() { return "Character"; }
+    const char *typeTag() const override { return tag(); }
 
     // Переопределение метода attack
     void attackEnemy(Entity& target) override
@@ -82,78 +575,873 @@ public:
         std::cout<<"Character healed with "<< amount<< " HP"<<std::endl;
     }
 
-    // Переопределение метода displayInfo
-    void displayInfo() const override
+    // Переопределение метода appendInfo
+    void appendInfo(TextBuffer &out) const override { appendStats(out, "Character: "); }
+};
+
+class Monster : public Entity
+{
+public:
+    Monster(const std::string &n, int h, int a, int d)
+        : Entity(n, h, a, d) {}
+    explicit Monster(RecordReader &in) : Entity(in) {}
+
+    static const char *tag() { return "Monster"; }
+    const char *typeTag() const override { return tag(); }
+
+    // Переопределение метода attack
+    void attackEnemy(Entity& target) override
     {
-        std::cout << "Character: " << name << ", HP: " << health
-                  << ", Attack: " << attack << ", Defense: " << defense << std::endl;
+        int damage = attack - target.getDefence();
+        if (damage > 0)
+        {
+            // Шанс на ядовитую атаку (30%)
+            if (rand() % 100 < 30)
+            {
+                damage += 5; // Дополнительный урон от яда
+                std::cout << "Poisonous attack! ";
+            }
+            target.takeDamage(damage);
+            std::cout << name << " attacks " << target.getName() << " for " << damage << " damage!\n";
+        }
+        else
+        {
+            std::cout << name << " attacks " << target.getName() << ", but it has no effect!\n";
+        }
+    }
+
+    // Переопределение метода appendInfo
+    void appendInfo(TextBuffer &out) const override { appendStats(out, "Monster: "); }
+};
+
+class Boss : public Monster
+{
+private:
+    std::string specialAbility;
+    int specialAbility_damage;
+
+public:
+    Boss(const std::string &n, int h, int a, int d, const std::string& sa, int sa_d)
+        : Monster(n, h, a, d), specialAbility(sa), specialAbility_damage(sa_d) {}
+    explicit Boss(RecordReader &in)
+        : Monster(in), specialAbility(in.readString()), specialAbility_damage(in.readInt()) {}
+
+    static const char *tag() { return "Boss"; }
+    const char *typeTag() const override { return tag(); }
+    void save(RecordWriter &out) const override
+    {
+        Monster::save(out);
+        out.writeString(specialAbility);
+        out.writeInt(specialAbility_damage);
+    }
+
+    void attackEnemy(Entity &target) override
+    {
+        int damage = attack + specialAbility_damage;
+        target.takeDamage(damage);
+        std::cout << "Boss used Special Ability! It takes " << damage << " damage" << std::endl;
+    }
+
+    void appendInfo(TextBuffer &out) const override
+    {
+        appendStats(out, "Boss: ");
+        out << ", Special Ability: " << specialAbility << " (" << specialAbility_damage << ')';
     }
 };
+
+// Регистрация типов для загрузки сохранений
+const bool entityRegistered = EntityRegistry::add<Entity>();
+const bool characterRegistered = EntityRegistry::add<Character>();
+const bool monsterRegistered = EntityRegistry::add<Monster>();
+const bool bossRegistered = EntityRegistry::add<Boss>();
+
+enum class SaveFormat
+{
+    Binary,
+    Text
+};
+
+// Двоичное сохранение: [магия "ENTB"][версия u32][число записей u32][число тегов u32][теги],
+// далее записи [длина u32][номер тега u32][поля]. Длина позволяет пропустить запись незнакомого типа.
+// Текстовое сохранение: строка "ENTT <версия> <число записей>", далее по строке на запись: тег и поля через \t.
+// Файл без магии читается как старый формат "имя здоровье атака защита" (только Character)
+const char binaryMagic[4] = {'E', 'N', 'T', 'B'};
+const char textMagic[4] = {'E', 'N', 'T', 'T'};
+const uint32_t saveVersion = 1;
+const size_t ioBufferSize = 1 << 20;
+const size_t displayBlockSize = 64 * 1024;
+
+// Разбитое сохранение: манифест "ENTM <версия> <число частей> <число записей>", далее по строке на часть:
+// имя файла, число записей и размер в байтах через \t. Каждая часть — обычное двоичное сохранение
+const char manifestMagic[4] = {'E', 'N', 'T', 'M'};
+
+struct ShardInfo
+{
+    std::string file; // Имя относительно каталога манифеста
+    size_t count;
+    uintmax_t bytes;
+};
+
+// Выполняет work(0..count-1) в threads потоках; исключение из потока пробрасывается после join
+template <typename Work>
+void runParallel(size_t count, size_t threads, Work work)
+{
+    threads = std::max<size_t>(1, std::min(threads, count));
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t < threads; ++t)
+    {
+        pool.emplace_back([&, t]
+        {
+            try
+            {
+                for (size_t i = t; i < count; i += threads)
+                {
+                    work(i);
+                }
+            }
+            catch (...)
+            {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+    for (std::thread &thread : pool)
+    {
+        thread.join();
+    }
+    for (const std::exception_ptr &error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+// Имя части — только имя файла в каталоге манифеста: чужой или испорченный манифест
+// не должен открывать или удалять файлы за его пределами
+bool isShardFileName(const std::string &name)
+{
+    std::filesystem::path path(name);
+    return !name.empty() && name != "." && name != ".." && path.filename() == path && !path.has_root_path();
+}
+
+std::vector<ShardInfo> readManifest(const std::string &filename)
+{
+    std::ifstream file(filename);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open manifest for reading.");
+    }
+    std::string line;
+    std::getline(file, line);
+    std::istringstream header(line);
+    std::string magic;
+    uint32_t version = 0;
+    size_t shards = 0, total = 0;
+    header >> magic >> version >> shards >> total;
+    if (magic != std::string(manifestMagic, sizeof(manifestMagic)) || version == 0 || version > saveVersion)
+    {
+        throw std::runtime_error("Not a save manifest: " + filename);
+    }
+    // Имя части может содержать пробелы, поэтому строка делится только по \t
+    std::vector<ShardInfo> parts(shards);
+    size_t sum = 0;
+    for (ShardInfo &part : parts)
+    {
+        if (!std::getline(file, line))
+        {
+            throw std::runtime_error("Save manifest is truncated");
+        }
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        size_t nameEnd = line.find('\t');
+        size_t countEnd = nameEnd == std::string::npos ? nameEnd : line.find('\t', nameEnd + 1);
+        if (countEnd == std::string::npos)
+        {
+            throw std::runtime_error("Save manifest is malformed");
+        }
+        part.file = line.substr(0, nameEnd);
+        std::istringstream numbers(line.substr(nameEnd + 1));
+        if (!(numbers >> part.count >> part.bytes))
+        {
+            throw std::runtime_error("Save manifest is malformed");
+        }
+        if (!isShardFileName(part.file))
+        {
+            throw std::runtime_error("Save manifest refers to a file outside its directory: " + part.file);
+        }
+        sum += part.count;
+    }
+    if (sum != total)
+    {
+        throw std::runtime_error("Save manifest is inconsistent");
+    }
+    return parts;
+}
+
+// Менеджер владеет сущностями в пуле слотов; снаружи они доступны по поколенческим дескрипторам
 template <typename T>
 class GameManager
 {
-    private: std::vector<T> entities;
-public:
-    void addEntity(T entity)
+    private: SlabPool<T, entitySlotSize> entities;
+
+    // Записи копятся в буфере и уходят в файл кусками, а не по одной
+    static void flushIfFull(std::ofstream &file, std::string &buffer, bool force = false)
+    {
+        if (force || buffer.size() >= ioBufferSize)
+        {
+            file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+
+    using Iterator = typename SlabPool<T, entitySlotSize>::const_iterator;
+
+    // Возвращает число записанных сущностей
+    static size_t saveBinary(std::ofstream &file, Iterator first, Iterator last)
+    {
+        // Таблица тегов пишется один раз, у записи — только номер тега
+        std::vector<std::string> tags;
+        std::unordered_map<std::string, uint32_t> tagIndex;
+        size_t count = 0;
+        for (Iterator it = first; it != last; ++it, ++count)
+        {
+            const T *entity = *it;
+            if (tagIndex.emplace(entity->typeTag(), static_cast<uint32_t>(tags.size())).second)
+            {
+                tags.push_back(entity->typeTag());
+            }
+        }
+
+        std::string buffer(binaryMagic, sizeof(binaryMagic));
+        BinaryRecordWriter out(buffer);
+        out.writeU32(saveVersion);
+        out.writeU32(static_cast<uint32_t>(count));
+        out.writeU32(static_cast<uint32_t>(tags.size()));
+        for (const std::string &tag : tags)
+        {
+            out.writeString(tag);
+        }
+
+        std::string record;
+        BinaryRecordWriter fields(record);
+        for (Iterator it = first; it != last; ++it)
+        {
+            const T *entity = *it;
+            record.clear();
+            fields.writeU32(tagIndex[entity->typeTag()]);
+            entity->save(fields);
+            out.writeU32(static_cast<uint32_t>(record.size()));
+            buffer += record;
+            flushIfFull(file, buffer);
+        }
+        flushIfFull(file, buffer, true);
+        return count;
+    }
+
+    void saveText(std::ofstream &file) const
     {
-        if (entity->getHealth() <= 0)
+        std::string buffer = std::string(textMagic, sizeof(textMagic)) + " " + std::to_string(saveVersion) + " " +
+                             std::to_string(entities.size()) + "\n";
+        TextRecordWriter out(buffer);
+        for (const auto &entity : entities)
         {
-            throw std::invalid_argument("Entity has invalid health");
+            buffer += entity->typeTag();
+            entity->save(out);
+            buffer += '\n';
+            flushIfFull(file, buffer);
         }
-        entities.push_back(entity);
+        flushIfFull(file, buffer, true);
+    }
+
+    static uint32_t readU32(std::istream &file)
+    {
+        char bytes[4];
+        if (!file.read(bytes, 4))
+        {
+            throw std::runtime_error("Save file is truncated");
+        }
+        return BinaryRecordReader(bytes, 4).readU32();
+    }
+
+    // Читает двоичное сохранение после магии: start(count) получает число записей,
+    // store(factory, in) — каждую запись; для незнакомого типа factory пустая
+    template <typename Start, typename Store>
+    static void readBinary(std::istream &file, Start start, Store store)
+    {
+        uint32_t version = readU32(file);
+        if (version == 0 || version > saveVersion)
+        {
+            throw std::runtime_error("Unsupported save version: " + std::to_string(version));
+        }
+        uint32_t count = readU32(file);
+        uint32_t tagCount = readU32(file);
+        std::vector<EntityRegistry::Factory> factories;
+        std::string payload;
+        for (uint32_t i = 0; i < tagCount; ++i)
+        {
+            payload.resize(readU32(file));
+            if (!file.read(&payload[0], static_cast<std::streamsize>(payload.size())))
+            {
+                throw std::runtime_error("Save file is truncated");
+            }
+            factories.push_back(EntityRegistry::find(payload));
+        }
+
+        start(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            payload.resize(readU32(file));
+            if (!file.read(&payload[0], static_cast<std::streamsize>(payload.size())))
+            {
+                throw std::runtime_error("Save file is truncated");
+            }
+            BinaryRecordReader in(payload.data(), payload.size());
+            uint32_t tag = in.readU32();
+            if (tag >= factories.size())
+            {
+                throw std::runtime_error("Save record has an invalid type tag");
+            }
+            store(factories[tag], in);
+        }
+    }
+
+    size_t loadBinary(std::ifstream &file)
+    {
+        size_t skipped = 0;
+        readBinary(
+            file, [this](uint32_t count) { entities.reserve(entities.size() + count); },
+            [&](EntityRegistry::Factory factory, RecordReader &in)
+            {
+                if (!factory)
+                {
+                    ++skipped;
+                    return;
+                }
+                entities.construct([&](void *slot) { return factory(slot, in); });
+            });
+        return skipped;
+    }
+
+    size_t loadText(std::ifstream &file)
+    {
+        std::string line;
+        std::getline(file, line);
+        std::istringstream header(line);
+        uint32_t version = 0;
+        size_t count = 0;
+        header >> version >> count;
+        if (version == 0 || version > saveVersion)
+        {
+            throw std::runtime_error("Unsupported save version: " + std::to_string(version));
+        }
+        entities.reserve(entities.size() + count);
+        size_t skipped = 0;
+        while (std::getline(file, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+            if (line.empty())
+            {
+                continue;
+            }
+            size_t tagEnd = line.find('\t');
+            EntityRegistry::Factory factory = EntityRegistry::find(line.substr(0, tagEnd));
+            if (!factory || tagEnd == std::string::npos)
+            {
+                ++skipped;
+                continue;
+            }
+            TextRecordReader in(line, tagEnd);
+            entities.construct([&](void *slot) { return factory(slot, in); });
+        }
+        return skipped;
+    }
+
+    // Старый формат без типов: каждая строка — Character
+    void loadLegacy(std::ifstream &file)
+    {
+        std::string name;
+        int health, attack, defense;
+        while (file >> name >> health >> attack >> defense) {
+            entities.template emplace<Character>(name, health, attack, defense);
+        }
+    }
+
+public:
+    GameManager() = default;
+    GameManager(const GameManager &) = delete;
+    GameManager &operator=(const GameManager &) = delete;
+
+    // Ошибка вынесена из горячего пути: бросок исключения внутри addEntity мешает компилятору
+    // встроить создание в цикл вызывающего
+    [[noreturn]] static void rejectHealth(T *entity)
+    {
+        entity->~T();
+        throw std::invalid_argument("Entity has invalid health");
     }
-    void saveToFile(const std::string& filename)
+
+    // Здоровье проверяется сразу после построения, до учёта в пуле: при ошибке слот просто возвращается
+    template <typename U, typename... Args>
+    SlabHandle addEntity(Args &&...args)
+    {
+        static_assert(std::is_base_of<T, U>::value && sizeof(U) <= entitySlotSize, "Entity type does not fit");
+        return entities.construct([&](void *slot) -> T *
+        {
+            U *entity = new (slot) U(std::forward<Args>(args)...);
+            if (entity->getHealth() <= 0)
+            {
+                rejectHealth(entity);
+            }
+            return entity;
+        });
+    }
+    T *get(SlabHandle handle) { return entities.get(handle); }
+    bool removeEntity(SlabHandle handle) { return entities.destroy(handle); }
+    void clear() { entities.clear(); }
+    void saveToFile(const std::string& filename, SaveFormat format = SaveFormat::Binary)
     {
-        std::ofstream file(filename);
+        std::ofstream file(filename, std::ios::binary);
         if (!file.is_open())
         {
             throw std::runtime_error("Failed to open file for writing.");
         }
-        for (const auto& entity : entities) {
-            file << entity->getName() << " " << entity->getHealth() << " "
-                 << entity->getAttack() << " " << entity->getDefence() << "\n";
+        if (format == SaveFormat::Binary)
+            saveBinary(file, entities.begin(), entities.end());
+        else
+            saveText(file);
+        if (!file)
+        {
+            throw std::runtime_error("Failed to write save file.");
         }
         file.close();
     }
 
-    void loadFromFile(GameManager<Entity *> &manager, const std::string &filename)
+    // Формат определяется по первым байтам файла
+    void loadFromFile(const std::string &filename)
     {
-        std::ifstream file(filename);
+        std::vector<char> buffer(ioBufferSize);
+        std::ifstream file;
+        file.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        file.open(filename, std::ios::binary);
         if (!file.is_open())
         {
             throw std::runtime_error("Failed to open file for reading.");
         }
-        std::string name;
-        int health, attack, defense;
-        while (file >> name >> health >> attack >> defense) {
-            entities.push_back(new Character(name, health, attack, defense));
+        char magic[4] = {};
+        file.read(magic, sizeof(magic));
+        size_t skipped = 0;
+        if (file.gcount() == 4 && std::equal(magic, magic + 4, binaryMagic))
+        {
+            skipped = loadBinary(file);
+        }
+        else if (file.gcount() == 4 && std::equal(magic, magic + 4, textMagic))
+        {
+            skipped = loadText(file);
+        }
+        else
+        {
+            file.clear();
+            file.seekg(0);
+            loadLegacy(file);
+        }
+        if (skipped > 0)
+        {
+            std::cerr << "Skipped " << skipped << " records of unknown types\n";
         }
         file.close();
     }
-    void displayAll() const {
-        for (const auto& entity : entities) {
-            entity->displayInfo();
+    // Сохраняет сущности в shards двоичных частей рядом с манифестом, каждую часть пишет свой поток.
+    // Части получают новые имена, а манифест заменяется последним, поэтому сбой посередине
+    // оставляет прежнее сохранение целым
+    void saveSharded(const std::string &manifestName, size_t shards)
+    {
+        shards = std::max<size_t>(1, std::min(shards, entities.size()));
+        std::filesystem::path manifestPath(manifestName);
+        std::filesystem::path directory = manifestPath.parent_path();
+        std::vector<ShardInfo> previous;
+        try
+        {
+            previous = readManifest(manifestName);
+        }
+        catch (const std::exception &)
+        {
+        }
+
+        const std::string stamp = std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+        std::vector<ShardInfo> parts(shards);
+        const std::string tempName = manifestName + ".tmp";
+        // Части, записанные до сбоя другого потока, удаляются: манифест на них не сошлётся
+        auto removeWritten = [&]
+        {
+            std::error_code ignored;
+            for (const ShardInfo &part : parts)
+            {
+                if (!part.file.empty())
+                    std::filesystem::remove(directory / part.file, ignored);
+            }
+            std::filesystem::remove(tempName, ignored);
+        };
+        try
+        {
+            runParallel(shards, shards, [&](size_t k)
+            {
+                // Части делят диапазон слотов; живых сущностей в них может быть немного по-разному
+                Iterator first = entities.slot(entities.slotCount() * k / shards);
+                Iterator last = entities.slot(entities.slotCount() * (k + 1) / shards);
+                ShardInfo &part = parts[k];
+                part.file = manifestPath.filename().string() + "." + stamp + "." + std::to_string(k);
+                std::filesystem::path path = directory / part.file;
+                std::ofstream file(path, std::ios::binary);
+                if (!file.is_open())
+                {
+                    throw std::runtime_error("Failed to open save shard for writing.");
+                }
+                part.count = saveBinary(file, first, last);
+                file.close();
+                if (!file)
+                {
+                    throw std::runtime_error("Failed to write save shard.");
+                }
+                part.bytes = std::filesystem::file_size(path);
+            });
+
+            {
+                std::ofstream file(tempName);
+                file << std::string(manifestMagic, sizeof(manifestMagic)) << ' ' << saveVersion << ' ' << shards << ' '
+                     << entities.size() << '\n';
+                for (const ShardInfo &part : parts)
+                {
+                    file << part.file << '\t' << part.count << '\t' << part.bytes << '\n';
+                }
+                if (!file)
+                {
+                    throw std::runtime_error("Failed to write save manifest.");
+                }
+            }
+            std::filesystem::rename(tempName, manifestName);
+        }
+        catch (...)
+        {
+            removeWritten();
+            throw;
+        }
+        for (const ShardInfo &part : previous)
+        {
+            std::error_code ignored;
+            std::filesystem::remove(directory / part.file, ignored);
+        }
+    }
+
+    // Части читаются параллельно прямо в заранее выделенные слоты пула,
+    // затем объединяются в порядке манифеста
+    void loadSharded(const std::string &manifestName, size_t threads)
+    {
+        std::vector<ShardInfo> parts = readManifest(manifestName);
+        std::filesystem::path directory = std::filesystem::path(manifestName).parent_path();
+        std::vector<size_t> offsets(parts.size());
+        size_t total = 0;
+        for (size_t k = 0; k < parts.size(); ++k)
+        {
+            std::error_code error;
+            if (std::filesystem::file_size(directory / parts[k].file, error) != parts[k].bytes || error)
+            {
+                throw std::runtime_error("Save shard does not match manifest: " + parts[k].file);
+            }
+            offsets[k] = total;
+            total += parts[k].count;
+        }
+
+        uint32_t first = entities.claim(total);
+        std::vector<size_t> skipped(parts.size());
+        try
+        {
+            runParallel(parts.size(), threads, [&](size_t k)
+            {
+                std::vector<char> buffer(ioBufferSize);
+                std::ifstream file;
+                file.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                file.open(directory / parts[k].file, std::ios::binary);
+                char magic[4] = {};
+                if (!file.read(magic, sizeof(magic)) || !std::equal(magic, magic + 4, binaryMagic))
+                {
+                    throw std::runtime_error("Save shard is not a binary save: " + parts[k].file);
+                }
+                uint32_t index = static_cast<uint32_t>(first + offsets[k]);
+                readBinary(
+                    file,
+                    [&](uint32_t count)
+                    {
+                        if (count != parts[k].count)
+                        {
+                            throw std::runtime_error("Save shard does not match manifest: " + parts[k].file);
+                        }
+                    },
+                    [&](EntityRegistry::Factory factory, RecordReader &in)
+                    {
+                        if (factory)
+                            entities.constructAt(index, [&](void *slot) { return factory(slot, in); });
+                        else
+                            ++skipped[k];
+                        ++index;
+                    });
+            });
+        }
+        catch (...)
+        {
+            // Уже построенные сущности остаются в менеджере, как и при обычной загрузке
+            entities.commit(first, total);
+            throw;
+        }
+        entities.commit(first, total);
+        size_t skippedTotal = 0;
+        for (size_t count : skipped)
+        {
+            skippedTotal += count;
+        }
+        if (skippedTotal > 0)
+        {
+            std::cerr << "Skipped " << skippedTotal << " records of unknown types\n";
         }
     }
-    ~GameManager() {
-        for (auto entity : entities) {
-            delete entity;  // Освобождаем память
+
+    size_t size() const { return entities.size(); }
+    // Строки копятся в одном буфере и выводятся блоками по displayBlockSize байт
+    void displayAll() const {
+        TextBuffer &out = TextBuffer::local();
+        for (const T *entity : entities) {
+            entity->appendInfo(out);
+            out << '\n';
+            if (out.size() >= displayBlockSize) {
+                out.writeTo(std::cout);
+            }
         }
+        out.writeTo(std::cout);
     }
 };
 
-int main()
+// Замер скорости сохранения и загрузки count сущностей в обоих форматах и в shards частях
+void runBenchmark(size_t count, size_t shards)
+{
+    GameManager<Entity> manager;
+    for (size_t i = 0; i < count; ++i)
+    {
+        switch (i % 3)
+        {
+        case 0:
+            manager.addEntity<Character>("Hero " + std::to_string(i), 100, 20, 10);
+            break;
+        case 1:
+            manager.addEntity<Monster>("Goblin " + std::to_string(i), 50, 15, 5);
+            break;
+        default:
+            manager.addEntity<Boss>("Dragon " + std::to_string(i), 300, 50, 20, "Fireball", 30);
+        }
+    }
+
+    const SaveFormat formats[] = {SaveFormat::Binary, SaveFormat::Text};
+    for (SaveFormat format : formats)
+    {
+        const std::string filename = format == SaveFormat::Binary ? "bench_save.dat" : "bench_save.txt";
+        auto started = std::chrono::steady_clock::now();
+        manager.saveToFile(filename, format);
+        double saveSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        GameManager<Entity> loaded;
+        started = std::chrono::steady_clock::now();
+        loaded.loadFromFile(filename);
+        double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        double megabytes = static_cast<double>(file.tellg()) / (1 << 20);
+        file.close();
+        std::remove(filename.c_str());
+        if (loaded.size() != count)
+        {
+            throw std::runtime_error("Benchmark loaded " + std::to_string(loaded.size()) + " entities");
+        }
+        std::cout << (format == SaveFormat::Binary ? "Binary" : "Text") << ": " << megabytes << " MB\n"
+                  << "  save: " << count / saveSeconds << " entities/sec, " << megabytes / saveSeconds << " MB/s\n"
+                  << "  load: " << count / loadSeconds << " entities/sec, " << megabytes / loadSeconds << " MB/s\n";
+    }
+
+    const std::string manifest = "bench_save.manifest";
+    auto started = std::chrono::steady_clock::now();
+    manager.saveSharded(manifest, shards);
+    double saveSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    GameManager<Entity> loaded;
+    started = std::chrono::steady_clock::now();
+    loaded.loadSharded(manifest, shards);
+    double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::vector<ShardInfo> parts = readManifest(manifest);
+    for (const ShardInfo &part : parts)
+    {
+        std::remove(part.file.c_str());
+    }
+    std::remove(manifest.c_str());
+    if (loaded.size() != count)
+    {
+        throw std::runtime_error("Benchmark loaded " + std::to_string(loaded.size()) + " entities");
+    }
+    std::cout << "Sharded binary, " << parts.size() << " parts:\n"
+              << "  save: " << count / saveSeconds << " entities/sec\n"
+              << "  load: " << count / loadSeconds << " entities/sec\n";
+}
+
+// Замер создания и удаления вперемешку: пул слотов против отдельных new/delete.
+// Варианты чередуются trials раз и берётся лучшее время каждого этапа: одиночный прогон слишком
+// шумный, а вариант, идущий первым, ещё и платит за первое касание страниц памяти
+void runChurnBenchmark(size_t count)
+{
+    const size_t rounds = 5;
+    const int trials = 5;
+    std::mt19937 random(42);
+    std::vector<size_t> victims(count * rounds);
+    for (size_t &victim : victims)
+    {
+        victim = random() % count;
+    }
+    auto create = [](auto &&make, size_t i)
+    {
+        switch (i % 3)
+        {
+        case 0:
+            return make(static_cast<Character *>(nullptr), i);
+        case 1:
+            return make(static_cast<Monster *>(nullptr), i);
+        default:
+            return make(static_cast<Boss *>(nullptr), i);
+        }
+    };
+    auto seconds = [](std::chrono::steady_clock::time_point started)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    };
+
+    struct Times
+    {
+        double fill = 1e30;
+        double churn = 1e30;
+        double clear = 1e30;
+    };
+    auto keepBest = [](Times &best, double fill, double churn, double clear)
+    {
+        best.fill = std::min(best.fill, fill);
+        best.churn = std::min(best.churn, churn);
+        best.clear = std::min(best.clear, clear);
+    };
+
+    // Менеджер один на все попытки: clear() оставляет слоты пулу, как и free оставляет
+    // освобождённые блоки malloc, поэтому со второй попытки обе стороны работают с прогретой памятью
+    GameManager<Entity> manager;
+    Times pool, heap;
+    for (int trial = 0; trial < trials; ++trial)
+    {
+        {
+            std::vector<SlabHandle> handles;
+            handles.reserve(count);
+            auto make = [&manager](auto *type, size_t i)
+            {
+                using Type = std::remove_pointer_t<decltype(type)>;
+                if constexpr (std::is_same<Type, Boss>::value)
+                    return manager.addEntity<Boss>("Dragon", 300, 50, 20, "Fireball", 30);
+                else
+                    return manager.addEntity<Type>("Goblin", 50 + static_cast<int>(i % 7), 15, 5);
+            };
+            auto started = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < count; ++i)
+            {
+                handles.push_back(create(make, i));
+            }
+            double fill = seconds(started);
+            started = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < victims.size(); ++i)
+            {
+                manager.removeEntity(handles[victims[i]]);
+                handles[victims[i]] = create(make, i);
+            }
+            double churn = seconds(started);
+            started = std::chrono::steady_clock::now();
+            manager.clear();
+            keepBest(pool, fill, churn, seconds(started));
+        }
+        {
+            std::vector<Entity *> pointers;
+            pointers.reserve(count);
+            auto make = [](auto *type, size_t i) -> Entity *
+            {
+                using Type = std::remove_pointer_t<decltype(type)>;
+                if constexpr (std::is_same<Type, Boss>::value)
+                    return new Boss("Dragon", 300, 50, 20, "Fireball", 30);
+                else
+                    return new Type("Goblin", 50 + static_cast<int>(i % 7), 15, 5);
+            };
+            auto started = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < count; ++i)
+            {
+                pointers.push_back(create(make, i));
+            }
+            double fill = seconds(started);
+            started = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < victims.size(); ++i)
+            {
+                delete pointers[victims[i]];
+                pointers[victims[i]] = create(make, i);
+            }
+            double churn = seconds(started);
+            started = std::chrono::steady_clock::now();
+            for (Entity *entity : pointers)
+            {
+                delete entity;
+            }
+            keepBest(heap, fill, churn, seconds(started));
+        }
+    }
+    std::cout << "Best of " << trials << " trials:\n"
+              << "Slab pool: create " << count / pool.fill << "/sec, churn " << victims.size() / pool.churn
+              << " destroy+create/sec, clear " << pool.clear * 1000 << " ms\n"
+              << "new/delete: create " << count / heap.fill << "/sec, churn " << victims.size() / heap.churn
+              << " destroy+create/sec, clear " << heap.clear * 1000 << " ms\n";
+}
+
+// Запуск: 7_1 [--bench N [частей] | --churn N]
+int main(int argc, char *argv[])
 {
     try{
-    GameManager<Entity *> manager;
-    manager.addEntity(new Character("Hero", 100, 20,10));
-    manager.saveToFile("game_save.txt");
+    if (argc > 2 && std::string(argv[1]) == "--bench")
+    {
+        runBenchmark(std::stoul(argv[2]),
+                     argc > 3 ? std::stoul(argv[3]) : std::max(1u, std::thread::hardware_concurrency()));
+        return 0;
+    }
+    if (argc > 2 && std::string(argv[1]) == "--churn")
+    {
+        runChurnBenchmark(std::stoul(argv[2]));
+        return 0;
+    }
+    GameManager<Entity> manager;
+    manager.addEntity<Character>("Hero", 100, 20,10);
+    manager.addEntity<Monster>("Goblin", 50, 15, 5);
+    manager.addEntity<Boss>("Dark Lord", 300, 50, 20, "Fire Breath", 30);
+    manager.saveToFile("game_save.dat");
+    manager.saveToFile("game_save.txt", SaveFormat::Text);
     std::cout << "Game saved successfully.\n";
 
-    GameManager<Entity *> loadedManager;
-    loadedManager.loadFromFile(loadedManager, "game_save.txt");
+    GameManager<Entity> loadedManager;
+    loadedManager.loadFromFile("game_save.dat");
     std::cout << "Loaded entities:\n";
     loadedManager.displayAll();
+
+    GameManager<Entity> textManager;
+    textManager.loadFromFile("game_save.txt");
+    std::cout << "Loaded from text:\n";
+    textManager.displayAll();
     }
     catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
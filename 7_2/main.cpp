@@ -1,50 +1,222 @@
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cmath>
+#include <ctime>
+#include <random>
 #include <vector>
 #include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include <string>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <variant>
+#include <memory>
+#include <type_traits>
+#include "../common/Text_buffer.h"
+
+// Кэш базового урона для пар (версия характеристик атакующего, версия характеристик цели).
+// При изменении атаки или защиты сущность получает новую версию, и старые записи перестают совпадать.
+// Бои идут в отдельных потоках, поэтому у каждого потока свой кэш, а счётчики
+// завершившихся потоков складываются в общие атомарные суммы
+class DamageCache
+{
+public:
+    struct Entry
+    {
+        unsigned long long key = 0;
+        int damage = 0;     // 0 — удар не пробивает защиту
+        int hitsToKill = 0; // Ударов до гибели цели с полным здоровьем, 0 — убить нельзя
+    };
+
+private:
+    static const unsigned slotCount = 64;
+    Entry slots[slotCount];
+    unsigned long long hits = 0;
+    unsigned long long misses = 0;
+
+    inline static std::atomic<unsigned long long> finishedHits{0};
+    inline static std::atomic<unsigned long long> finishedMisses{0};
+
+public:
+    DamageCache() = default;
+    DamageCache(const DamageCache &) = delete;
+    DamageCache &operator=(const DamageCache &) = delete;
+    ~DamageCache()
+    {
+        finishedHits += hits;
+        finishedMisses += misses;
+    }
+
+    static DamageCache &local()
+    {
+        thread_local DamageCache cache;
+        return cache;
+    }
+
+    template <typename Compute>
+    const Entry &lookup(unsigned attackerVersion, unsigned defenderVersion, Compute compute)
+    {
+        unsigned long long key = (static_cast<unsigned long long>(attackerVersion) << 32) | defenderVersion;
+        Entry &entry = slots[(attackerVersion * 31 + defenderVersion) % slotCount];
+        if (entry.key == key)
+        {
+            ++hits;
+            return entry;
+        }
+        ++misses;
+        entry = compute();
+        entry.key = key;
+        return entry;
+    }
+
+    unsigned long long getHits() const { return hits; }
+    unsigned long long getMisses() const { return misses; }
+
+    // Счётчики потоков, которые уже завершились
+    static unsigned long long totalHits() { return finishedHits; }
+    static unsigned long long totalMisses() { return finishedMisses; }
+};
+
+// Вывод боя. В нагрузочном режиме он отключается, чтобы мерить бои, а не консоль;
+// у каждого потока свой немой поток вывода, так как запись в ostream меняет его состояние
+std::atomic<bool> battleLogEnabled{true};
+
+std::ostream &battleLog()
+{
+    thread_local std::ostream muted(nullptr);
+    return battleLogEnabled ? std::cout : muted;
+}
+
+// Шансы и сила случайных модификаторов удара; по ним же считает оценщик исхода боя
+const int critPercent = 20;   // Крит героя удваивает урон
+const int poisonPercent = 30; // Яд монстра добавляет poisonDamage
+const int poisonDamage = 5;
+
+// Случайные числа для критов и яда: rand() общий для всех потоков
+int randomPercent()
+{
+    thread_local std::minstd_rand generator(std::random_device{}());
+    return static_cast<int>(generator() % 100);
+}
+
+// Результат удара: сколько урона прошло и стал ли этот удар смертельным
+struct Hit
+{
+    int damage = 0;
+    bool killed = false;
+};
 
 class Entity
 {
 protected:
     std::string name;
-    int health;
+    // Здоровье меняют бои из разных потоков; имя и характеристики после создания не меняются
+    std::atomic<int> health;
     int attack;
     int defense;
+    int maxHealth;        // Здоровье при создании, от него считается число ударов до победы
+    unsigned statVersion; // Версия характеристик для кэша урона
+
+    static unsigned nextStatVersion()
+    {
+        static std::atomic<unsigned> counter{0};
+        return ++counter; // Версия 0 не выдаётся, поэтому пустые записи кэша не совпадают ни с чем
+    }
+
+    // Строка "<label><имя>, HP: ..., Attack: ..., Defense: ..." с переводом строки
+    void appendStats(TextBuffer &out, const char *label) const
+    {
+        out << label << name << ", HP: " << health.load() << ", Attack: " << attack << ", Defense: " << defense << '\n';
+    }
+
+    DamageCache::Entry computeDamage(const Entity &target) const
+    {
+        DamageCache::Entry entry;
+        entry.damage = std::max(0, attack - target.defense);
+        entry.hitsToKill = entry.damage > 0 ? (target.maxHealth + entry.damage - 1) / entry.damage : 0;
+        return entry;
+    }
+
+    // Базовый урон по цели без случайных модификаторов
+    const DamageCache::Entry &baseDamage(const Entity &target) const
+    {
+        return DamageCache::local().lookup(statVersion, target.statVersion, [&] { return computeDamage(target); });
+    }
 public:
     Entity(const std::string &n, int h, int a, int d)
-        : name(n), health(h), attack(a), defense(d) {}
+        : name(n), health(h), attack(a), defense(d), maxHealth(h), statVersion(nextStatVersion()) {}
+
+    Entity(const Entity &other)
+        : name(other.name), health(other.health.load()), attack(other.attack), defense(other.defense),
+          maxHealth(other.maxHealth), statVersion(other.statVersion) {}
+
+    Entity &operator=(const Entity &other)
+    {
+        name = other.name;
+        health = other.health.load();
+        attack = other.attack;
+        defense = other.defense;
+        maxHealth = other.maxHealth;
+        statVersion = other.statVersion;
+        return *this;
+    }
 
     // Виртуальный метод для атаки
-    virtual void attackEnemy(Entity &target)
+    virtual Hit attackEnemy(Entity &target)
     {
-        int damage = attack - target.defense;
+        int damage = baseDamage(target).damage;
         if (damage > 0)
         {
-            target.health -= damage;
-            std::cout << name << " attacks " << target.name << " for " << damage << " damage!\n";
-        }
-        else
-        {
-            std::cout << name << " attacks " << target.name << ", but it has no effect!\n";
+            Hit hit = target.takeDamage(damage);
+            if (hit.damage > 0)
+                battleLog() << name << " attacks " << target.name << " for " << damage << " damage!\n";
+            return hit;
         }
+        battleLog() << name << " attacks " << target.name << ", but it has no effect!\n";
+        return Hit();
     }
     virtual void heal(int amount){
         health +=amount;
     }
     //Геттер для защиты и имени, т.к. поля протектед, а во всех переопределениях функции attackEnemy за target взят класс Entity
     int getDefence() const { return defense; }
+    int getAttack() const { return attack; }
     std::string getName() const { return name; }
-    void takeDamage(int damage) { health -= damage; }
+    int getHealth() const { return health; }
+
+    // Удар по уже погибшей сущности не проходит. Сравнение с обменом гарантирует,
+    // что из нескольких одновременных ударов смертельным окажется ровно один
+    Hit takeDamage(int damage)
+    {
+        int current = health.load();
+        do
+        {
+            if (current <= 0)
+            {
+                return Hit();
+            }
+        } while (!health.compare_exchange_weak(current, current - damage));
+        Hit hit;
+        hit.damage = damage;
+        hit.killed = current - damage <= 0;
+        return hit;
+    }
     bool isAlive() const { return health > 0; }
 
-    // Виртуальный метод для вывода информации
-    virtual void displayInfo() const
+    // Виртуальный метод, дописывающий информацию о сущности в out
+    virtual void appendInfo(TextBuffer &out) const { appendStats(out, "Name: "); }
+
+    // Вывод информации одним write, без сброса потока после строки
+    void displayInfo() const
     {
-        std::cout << "Name: " << name << ", HP: " << health
-                  << ", Attack: " << attack << ", Defense: " << defense << std::endl;
+        TextBuffer &out = TextBuffer::local();
+        appendInfo(out);
+        out.writeTo(std::cout);
     }
 
     // Виртуальный деструктор
@@ -58,32 +230,29 @@ public:
         : Entity(n, h, a, d) {}
 
     // Переопределение метода attack
-    void attackEnemy(Entity& target) override
+    Hit attackEnemy(Entity& target) override
     {
-        int damage = attack - target.getDefence();
+        int damage = baseDamage(target).damage;
         if (damage > 0)
         {
             // Шанс на ядовитую атаку (30%)
-            if (rand() % 100 < 30)
+            bool poisoned = randomPercent() < poisonPercent;
+            if (poisoned)
             {
-                damage += 5; // Дополнительный урон от яда
-                std::cout << "Poisonous attack! ";
+                damage += poisonDamage; // Дополнительный урон от яда
             }
-            target.takeDamage(damage);
-            std::cout << name << " attacks " << target.getName() << " for " << damage << " damage!\n";
-        }
-        else
-        {
-            std::cout << name << " attacks " << target.getName() << ", but it has no effect!\n";
+            Hit hit = target.takeDamage(damage);
+            if (hit.damage > 0)
+                battleLog() << (poisoned ? "Poisonous attack! " : "") << name << " attacks " << target.getName()
+                            << " for " << damage << " damage!\n";
+            return hit;
         }
+        battleLog() << name << " attacks " << target.getName() << ", but it has no effect!\n";
+        return Hit();
     }
 
-    // Переопределение метода displayInfo
-    void displayInfo() const override
-    {
-        std::cout << "Monster: " << name << ", HP: " << health
-                  << ", Attack: " << attack << ", Defense: " << defense << std::endl;
-    }
+    // Переопределение метода appendInfo
+    void appendInfo(TextBuffer &out) const override { appendStats(out, "Monster: "); }
 };
 
 class Character : public Entity
@@ -93,97 +262,1042 @@ public:
         : Entity(n, h, a, d) {}
 
     // Переопределение метода attack
-    void attackEnemy(Entity& target) override
+    Hit attackEnemy(Entity& target) override
     {
-        int damage = attack - target.getDefence();
+        int damage = baseDamage(target).damage;
         if (damage > 0)
         {
             // Шанс на критический удар (20%)
-            if (rand() % 100 < 20)
+            bool critical = randomPercent() < critPercent;
+            if (critical)
             {
                 damage *= 2;
-                std::cout << "Critical hit! ";
             }
-            target.takeDamage(damage);
-            std::cout << name << " attacks " << target.getName() << " for " << damage << " damage!\n";
-        }
-        else
-        {
-            std::cout << name << " attacks " << target.getName() << ", but it has no effect!\n";
+            Hit hit = target.takeDamage(damage);
+            if (hit.damage > 0)
+                battleLog() << (critical ? "Critical hit! " : "") << name << " attacks " << target.getName()
+                            << " for " << damage << " damage!\n";
+            return hit;
         }
+        battleLog() << name << " attacks " << target.getName() << ", but it has no effect!\n";
+        return Hit();
     }
     void heal(int amount){
         Entity::heal(amount);
-        std::cout<<"Character healed with "<< amount<< " HP"<<std::endl;
+        battleLog()<<"Character healed with "<< amount<< " HP\n";
     }
 
-    // Переопределение метода displayInfo
-    void displayInfo() const override
+    // Переопределение метода appendInfo
+    void appendInfo(TextBuffer &out) const override { appendStats(out, "Character: "); }
+};
+
+// Сущность по значению: конкретный тип хранится в индексе variant, поэтому сущности можно
+// держать подряд в одном векторе, а вызовы идут напрямую, без поиска по vtable
+using EntityValue = std::variant<Character, Monster>;
+
+inline Entity &asEntity(EntityValue &entity)
+{
+    return std::visit([](auto &concrete) -> Entity & { return concrete; }, entity);
+}
+
+// Квалифицированный вызов Type::method отключает виртуальную диспетчеризацию
+inline Hit attackEnemy(EntityValue &attacker, EntityValue &target)
+{
+    Entity &victim = asEntity(target);
+    return std::visit([&victim](auto &self)
+                      {
+                          using Type = std::decay_t<decltype(self)>;
+                          return self.Type::attackEnemy(victim);
+                      },
+                      attacker);
+}
+
+inline void heal(EntityValue &entity, int amount)
+{
+    std::visit([amount](auto &self)
+               {
+                   using Type = std::decay_t<decltype(self)>;
+                   self.Type::heal(amount);
+               },
+               entity);
+}
+
+inline void displayInfo(const EntityValue &entity)
+{
+    TextBuffer &out = TextBuffer::local();
+    std::visit([&out](const auto &self)
+               {
+                   using Type = std::decay_t<decltype(self)>;
+                   self.Type::appendInfo(out);
+               },
+               entity);
+    out.writeTo(std::cout);
+}
+
+// Колесо таймеров: событие через delay тиков кладётся в ячейку (текущий тик + delay) % размер.
+// Более дальние события лежат в той же ячейке и ждут своего оборота колеса
+class TimerWheel
+{
+public:
+    using Callback = std::function<void()>;
+    using TimerId = unsigned long long;
+
+private:
+    struct Timer
     {
-        std::cout << "Character: " << name << ", HP: " << health
-                  << ", Attack: " << attack << ", Defense: " << defense << std::endl;
+        TimerId id;
+        unsigned long long due;
+        Callback callback;
+    };
+
+    std::vector<std::vector<Timer>> slots;
+    unsigned long long now = 0;
+    TimerId nextId = 1;
+    size_t count = 0;
+
+public:
+    explicit TimerWheel(size_t size = 64) : slots(size) {}
+
+    TimerId schedule(unsigned long long delay, Callback callback)
+    {
+        delay = std::max(1ULL, delay); // Событие на текущий тик уже не успеет выполниться
+        unsigned long long due = now + delay;
+        slots[due % slots.size()].push_back(Timer{nextId, due, std::move(callback)});
+        ++count;
+        return nextId++;
+    }
+
+    bool cancel(TimerId id)
+    {
+        for (std::vector<Timer> &slot : slots)
+        {
+            for (size_t i = 0; i < slot.size(); ++i)
+            {
+                if (slot[i].id == id)
+                {
+                    slot.erase(slot.begin() + i);
+                    --count;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Переходит к следующему тику и выполняет его события; события могут ставить новые
+    void advance()
+    {
+        ++now;
+        std::vector<Timer> &slot = slots[now % slots.size()];
+        std::vector<Timer> due;
+        for (size_t i = 0; i < slot.size();)
+        {
+            if (slot[i].due == now)
+            {
+                due.push_back(std::move(slot[i]));
+                slot[i] = std::move(slot.back());
+                slot.pop_back();
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        count -= due.size();
+        for (Timer &timer : due)
+        {
+            timer.callback();
+        }
     }
+
+    unsigned long long currentTick() const { return now; }
+    size_t pending() const { return count; }
 };
 
-std::vector<Monster> monsters;
-std::mutex monstersMutex;
-std::mutex fightMutex;
+// Цикл с фиксированным логическим шагом в отдельном потоке. В реальном времени тик N начинается
+// в момент start + N * step (ошибка не накапливается), в режиме максимальной скорости тики идут подряд
+class FixedStepLoop
+{
+private:
+    TimerWheel wheel;
+    std::chrono::steady_clock::duration step;
+    bool maxSpeed;
+    std::atomic<bool> stopping{false};
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::thread thread;
+
+    unsigned long long ticks = 0;
+    double elapsedSeconds = 0;
+    double intervalSum = 0;
+    double intervalSquares = 0;
+    double maxLateness = 0;
 
-void generateMonsters() {
-    while (true) {
-        std::this_thread::sleep_for(std::chrono::seconds(3)); // Новый монстр каждые 3 секунды
-        std::lock_guard<std::mutex> lock(monstersMutex);
+    void run()
+    {
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point started = Clock::now();
+        Clock::time_point previous = started;
+        while (!stopping)
+        {
+            if (!maxSpeed)
+            {
+                Clock::time_point deadline = started + step * static_cast<long long>(ticks + 1);
+                std::unique_lock<std::mutex> lock(mutex);
+                if (wakeup.wait_until(lock, deadline, [this] { return stopping.load(); }))
+                {
+                    break;
+                }
+                maxLateness = std::max(maxLateness, std::chrono::duration<double, std::milli>(Clock::now() - deadline).count());
+            }
+            Clock::time_point tickStart = Clock::now();
+            double interval = std::chrono::duration<double, std::milli>(tickStart - previous).count();
+            previous = tickStart;
+            intervalSum += interval;
+            intervalSquares += interval * interval;
+            wheel.advance();
+            ++ticks;
+        }
+        elapsedSeconds = std::chrono::duration<double>(Clock::now() - started).count();
+    }
+
+public:
+    FixedStepLoop(std::chrono::milliseconds step, bool maxSpeed) : step(step), maxSpeed(maxSpeed) {}
+
+    ~FixedStepLoop()
+    {
+        stop();
+        join();
+    }
+
+    FixedStepLoop(const FixedStepLoop &) = delete;
+    FixedStepLoop &operator=(const FixedStepLoop &) = delete;
+
+    // Ставить события можно до start() или из событий самого цикла
+    TimerWheel &timers() { return wheel; }
+
+    // Событие каждые period тиков, пока action возвращает true
+    void every(unsigned long long period, std::function<bool()> action)
+    {
+        wheel.schedule(period, [this, period, action]
+                       {
+                           if (action())
+                           {
+                               every(period, action);
+                           }
+                       });
+    }
+
+    void start()
+    {
+        thread = std::thread(&FixedStepLoop::run, this);
+    }
+
+    // Можно вызывать из любого потока и из событий цикла: текущий тик доработает до конца
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeup.notify_all();
+    }
+
+    void join()
+    {
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+
+    // Статистику читать после join()
+    void report(std::ostream &out) const
+    {
+        double mean = ticks ? intervalSum / ticks : 0;
+        double jitter = ticks ? std::sqrt(std::max(0.0, intervalSquares / ticks - mean * mean)) : 0;
+        out << "Ticks: " << ticks << ", " << (elapsedSeconds > 0 ? ticks / elapsedSeconds : 0) << " ticks/sec\n"
+            << "Tick interval: mean " << mean << " ms, jitter (stddev) " << jitter << " ms";
+        if (!maxSpeed)
+        {
+            out << ", max lateness " << maxLateness << " ms";
+        }
+        out << std::endl;
+    }
+};
+
+// Логический шаг и периоды событий в тиках: прежние 3 с, 1 с и 500 мс при шаге 100 мс
+const std::chrono::milliseconds tickStep(100);
+const unsigned long long spawnPeriod = 30;
+const unsigned long long checkPeriod = 10;
+const unsigned long long roundPeriod = 5;
+
+// Вся игра выполняется событиями одного потока цикла, поэтому блокировки не нужны
+class Arena
+{
+private:
+    Character hero;
+    std::vector<Monster> monsters;
+    std::vector<Monster> currentMonster; // Пуст, пока боя нет
+    FixedStepLoop &loop;
+
+    bool spawnMonster()
+    {
         monsters.push_back(Monster("Goblin_" + std::to_string(rand()%1000), 50, 15, 5));
         std::cout << "New monster generated!\n";
+        return true;
     }
-}
-void fight(Character &hero, Monster& monster){
-    std::cout<<"\nBattle begins between "<<hero.getName()<<" and "<<monster.getName()<<"!\n";
-    while (hero.isAlive() && monster.isAlive()) {
-        std::lock_guard<std::mutex> lock(fightMutex);
-        
+
+    bool checkForFight()
+    {
+        if (currentMonster.empty() && !monsters.empty())
+        {
+            currentMonster.push_back(monsters.front());
+            monsters.erase(monsters.begin());
+            std::cout<<"\nBattle begins between "<<hero.getName()<<" and "<<currentMonster[0].getName()<<"!\n";
+            // Первый раунд сразу, следующие — через roundPeriod тиков
+            if (fightRound())
+            {
+                loop.every(roundPeriod, [this] { return fightRound(); });
+            }
+        }
+        return true;
+    }
+
+    // Один раунд боя; false, когда бой закончен
+    bool fightRound()
+    {
+        Monster &monster = currentMonster[0];
         // Ход героя
         hero.attackEnemy(monster);
         if (!monster.isAlive()) {
             std::cout << monster.getName() << " has been defeated!\n";
-            break;
+            hero.heal(20); // Герой восстанавливает здоровье после победы
+            finishFight();
+            return false;
         }
 
         // Ход монстра
         monster.attackEnemy(hero);
         if (!hero.isAlive()) {
             std::cout << hero.getName() << " has been defeated!\n";
-            break;
+            finishFight();
+            std::cout << "Game Over!\n";
+            loop.stop();
+            return false;
         }
+        return true;
+    }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    void finishFight()
+    {
+        currentMonster.clear();
+        std::cout << "\nCurrent status:\n";
+        hero.displayInfo();
+        std::cout << "Monsters remaining: " << monsters.size() << "\n";
+        const DamageCache &cache = DamageCache::local();
+        std::cout << "Damage cache: " << cache.getHits() << " hits, " << cache.getMisses() << " misses\n";
     }
-    
-    if (hero.isAlive()) {
-        hero.heal(20); // Герой восстанавливает здоровье после победы
+
+public:
+    Arena(FixedStepLoop &loop) : hero("Hero", 100, 20, 10), loop(loop)
+    {
+        loop.every(spawnPeriod, [this] { return spawnMonster(); });
+        loop.every(checkPeriod, [this] { return checkForFight(); });
+    }
+};
+
+// Нагрузочный режим: бои идут одновременно в нескольких потоках, общих блокировок нет,
+// здоровье меняется только атомарными операциями
+
+// Учёт одного потока: сколько урона прошло по герою и сколько он вылечил
+struct FightTally
+{
+    long long damageToHero = 0;
+    long long healed = 0;
+    long long damageToMonster = 0;
+    int kills = 0;
+    int fights = 0;
+};
+
+// Бой до гибели одной из сторон, как в Arena::fightRound, но без ожидания между раундами
+void fightToEnd(Character &hero, Monster &monster, FightTally &tally)
+{
+    ++tally.fights;
+    while (hero.isAlive() && monster.isAlive())
+    {
+        Hit hit = hero.attackEnemy(monster);
+        tally.damageToMonster += hit.damage;
+        if (hit.killed)
+        {
+            ++tally.kills;
+            hero.heal(20);
+            tally.healed += 20;
+            return;
+        }
+        tally.damageToHero += monster.attackEnemy(hero).damage;
     }
 }
 
-int main() {
-    Character hero("Hero", 100, 20, 10);
+template <typename Body>
+double runThreads(unsigned threads, Body body)
+{
+    auto started = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads; ++i)
+    {
+        workers.emplace_back(body, i);
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+}
 
-    std::thread monsterGenerator(generateMonsters);
-    monsterGenerator.detach(); // Отсоединяем поток
+// Оценка исхода боя героя с монстром по правилам fightToEnd: герой бьёт первым, его удар с шансом
+// critPercent удваивается, удар монстра с шансом poisonPercent усиливается ядом. Урон без модификаторов
+// постоянен, поэтому здоровье стороны после r ударов зависит только от числа сработавших модификаторов,
+// а раунды гибели героя и монстра независимы друг от друга
 
-    while (hero.isAlive()) {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+struct FighterStats
+{
+    int health = 0;
+    int attack = 0;
+    int defense = 0;
+};
 
-        std::lock_guard<std::mutex> lock(monstersMutex);
-        if (!monsters.empty()){
-            Monster currentMonster = monsters[0];
-            monsters.erase(monsters.begin());
-            std::thread fightThread(fight, std::ref(hero), std::ref(currentMonster));
-            fightThread.join();
-            std::cout << "\nCurrent status:\n";
-            hero.displayInfo();
-            std::cout << "Monsters remaining: " << monsters.size() << "\n";
+inline FighterStats statsOf(const Entity &entity)
+{
+    return FighterStats{entity.getHealth(), entity.getAttack(), entity.getDefence()};
+}
+
+struct FightOdds
+{
+    double heroWin = 0;
+    double monsterWin = 0;
+    double draw = 0;               // Ни одна из сторон не пробивает защиту другой
+    double margin = 0;             // Полуширина 95% доверительного интервала для heroWin, 0 у точного решения
+    double expectedRounds = 0;     // Среднее число раундов завершившегося боя
+    std::vector<double> rounds;    // rounds[r] — вероятность, что бой закончился в раунде r
+    long long samples = 0;         // Число смоделированных боёв, 0 у точного решения
+    double varianceReduction = 1;  // Во сколько раз дисперсия меньше, чем у независимых боёв
+};
+
+// Удар одной стороны: обычный урон, урон с модификатором и шанс модификатора
+struct Strike
+{
+    long long base = 0;
+    long long boosted = 0;
+    double chance = 0;
+};
+
+inline Strike heroStrike(const FighterStats &hero, const FighterStats &monster)
+{
+    Strike strike;
+    strike.base = std::max(0, hero.attack - monster.defense);
+    strike.boosted = strike.base * 2;
+    strike.chance = critPercent / 100.0;
+    return strike;
+}
+
+inline Strike monsterStrike(const FighterStats &monster, const FighterStats &hero)
+{
+    Strike strike;
+    strike.base = std::max(0, monster.attack - hero.defense);
+    strike.boosted = strike.base > 0 ? strike.base + poisonDamage : 0; // Яд не действует, если удар не прошёл
+    strike.chance = poisonPercent / 100.0;
+    return strike;
+}
+
+// За сколько ударов цель гарантированно погибнет; 0 — удары не пробивают защиту
+inline long long roundsToFall(int health, const Strike &strike)
+{
+    return strike.base > 0 ? std::max(1LL, (health + strike.base - 1) / strike.base) : 0;
+}
+
+// Раунд, к которому бой точно закончится; 0 — бой не начнётся или никогда не закончится
+inline long long fightRoundsBound(const FighterStats &hero, const FighterStats &monster)
+{
+    if (hero.health <= 0 || monster.health <= 0)
+        return 0;
+    long long monsterFalls = roundsToFall(monster.health, heroStrike(hero, monster));
+    long long heroFalls = roundsToFall(hero.health, monsterStrike(monster, hero));
+    if (monsterFalls == 0 || heroFalls == 0)
+        return std::max(monsterFalls, heroFalls);
+    return std::min(monsterFalls, heroFalls);
+}
+
+// Состояния с меньшей вероятностью отбрасываются: их вклад ниже точности double, а без отбрасывания
+// вероятности уходят в денормализованные числа, и каждый шаг дальше ~1000 раундов замедляется в десятки раз
+const double negligibleProbability = 1e-30;
+
+// died[r] — вероятность, что цель погибнет ровно от r-го удара. alive[i] — вероятность, что после r ударов
+// модификатор сработал first + i раз и цель ещё жива. Урон растёт с числом модификаторов, поэтому
+// погибшие состояния всегда в хвосте массива и снимаются с конца. Заметную вероятность имеют
+// O(sqrt(r)) состояний около среднего, поэтому весь расчёт занимает O(maxRounds^1.5) операций
+inline std::vector<double> deathRounds(int health, const Strike &strike, long long maxRounds)
+{
+    std::vector<double> died(maxRounds + 1, 0.0);
+    if (strike.base <= 0)
+        return died;
+    std::vector<double> alive(1, 1.0);
+    long long first = 0;
+    for (long long r = 1; r <= maxRounds && !alive.empty(); ++r)
+    {
+        alive.push_back(0.0);
+        for (size_t i = alive.size() - 1; i > 0; --i)
+        {
+            alive[i] = alive[i] * (1 - strike.chance) + alive[i - 1] * strike.chance;
+        }
+        alive[0] *= 1 - strike.chance;
+        while (!alive.empty())
+        {
+            long long k = first + static_cast<long long>(alive.size()) - 1;
+            if ((r - k) * strike.base + k * strike.boosted < health)
+                break;
+            died[r] += alive.back();
+            alive.pop_back();
+        }
+        while (!alive.empty() && alive.back() < negligibleProbability)
+            alive.pop_back();
+        size_t dropped = 0;
+        while (dropped < alive.size() && alive[dropped] < negligibleProbability)
+            ++dropped;
+        alive.erase(alive.begin(), alive.begin() + static_cast<std::ptrdiff_t>(dropped));
+        first += static_cast<long long>(dropped);
+    }
+    return died;
+}
+
+// Герой побеждает в раунде r, если монстр гибнет от r-го удара, а герой пережил r - 1 ударов монстра
+FightOdds exactFightOdds(const FighterStats &hero, const FighterStats &monster)
+{
+    FightOdds odds;
+    long long maxRounds = fightRoundsBound(hero, monster);
+    if (maxRounds == 0)
+    {
+        odds.draw = 1;
+        return odds;
+    }
+    std::vector<double> monsterDeath = deathRounds(monster.health, heroStrike(hero, monster), maxRounds);
+    std::vector<double> heroDeath = deathRounds(hero.health, monsterStrike(monster, hero), maxRounds);
+    odds.rounds.assign(maxRounds + 1, 0.0);
+    double heroStanding = 1;    // Герой жив перед раундом r
+    double monsterStanding = 1; // Монстр жив перед раундом r
+    double roundSum = 0;
+    for (long long r = 1; r <= maxRounds; ++r)
+    {
+        double heroWins = monsterDeath[r] * heroStanding;
+        double monsterWins = heroDeath[r] * (monsterStanding - monsterDeath[r]);
+        odds.heroWin += heroWins;
+        odds.monsterWin += monsterWins;
+        odds.rounds[r] = heroWins + monsterWins;
+        roundSum += r * odds.rounds[r];
+        heroStanding -= heroDeath[r];
+        monsterStanding -= monsterDeath[r];
+    }
+    odds.heroWin = std::min(1.0, odds.heroWin);
+    odds.monsterWin = std::min(1.0 - odds.heroWin, odds.monsterWin);
+    double finished = odds.heroWin + odds.monsterWin;
+    odds.draw = 1 - finished > 1e-12 ? 1 - finished : 0; // Остаток ниже ошибки округления — не ничья
+    odds.expectedRounds = finished > 0 ? roundSum / finished : 0;
+    return odds;
+}
+
+// Монте-Карло: бои идут пачками по laneCount дорожек. У каждой дорожки первой половины свой поток
+// xorshift32, вторая половина берёт инвертированные числа тех же потоков (антитетические пары):
+// удачный крит в одном бою — промах в парном, что снижает дисперсию среднего
+const size_t laneCount = 8;
+const size_t streamCount = laneCount / 2;
+
+inline uint64_t splitMix64(uint64_t &state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Предел работы Монте-Карло в пачко-раундах (пачка — laneCount боёв): ~0.1 с на одном ядре.
+// Для длинных боёв число выборок уменьшается, и интервал margin честно становится шире
+const long long monteCarloRoundBudget = 1LL << 21;
+
+// Потоки обновляются одним циклом без ветвлений, который компилятор переводит в векторные команды
+struct LaneStreams
+{
+    uint32_t state[streamCount];
+
+    explicit LaneStreams(uint64_t seed)
+    {
+        for (uint32_t &value : state)
+        {
+            value = static_cast<uint32_t>(splitMix64(seed)) | 1; // Нулевое состояние xorshift не меняется
+        }
+    }
+
+    void next(uint32_t *out)
+    {
+        for (size_t i = 0; i < streamCount; ++i)
+        {
+            uint32_t x = state[i];
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            state[i] = x;
+            out[i] = x;
+        }
+    }
+};
+
+// Итоги одного потока; pairSum и pairSquares — по средним победам героя в антитетических парах
+struct MonteCarloTally
+{
+    long long heroWins = 0;
+    long long fights = 0;
+    double pairSum = 0;
+    double pairSquares = 0;
+    long long pairs = 0;
+    std::vector<long long> rounds;
+};
+
+// Урон ограничен сверху здоровьем цели, чтобы уместить дорожки в 32 бита: исход от этого не меняется
+inline int32_t laneDamage(long long damage, int health)
+{
+    return static_cast<int32_t>(std::min<long long>(damage, health));
+}
+
+void simulateFights(const FighterStats &hero, const FighterStats &monster, long long maxRounds,
+                    long long batches, uint64_t seed, MonteCarloTally &tally)
+{
+    const Strike toMonster = heroStrike(hero, monster);
+    const Strike toHero = monsterStrike(monster, hero);
+    const int32_t heroBase = laneDamage(toMonster.base, monster.health);
+    const int32_t heroBoosted = laneDamage(toMonster.boosted, monster.health);
+    const int32_t monsterBase = laneDamage(toHero.base, hero.health);
+    const int32_t monsterBoosted = laneDamage(toHero.boosted, hero.health);
+    const uint32_t critLimit = static_cast<uint32_t>(toMonster.chance * 4294967296.0);
+    const uint32_t poisonLimit = static_cast<uint32_t>(toHero.chance * 4294967296.0);
+    LaneStreams crits(seed);
+    LaneStreams poisons(~seed);
+    uint32_t critDraw[streamCount];
+    uint32_t poisonDraw[streamCount];
+    tally.rounds.assign(maxRounds + 1, 0);
+
+    for (long long batch = 0; batch < batches; ++batch)
+    {
+        int32_t heroHealth[laneCount];
+        int32_t monsterHealth[laneCount];
+        int32_t outcome[laneCount];    // 0 — бой идёт, 1 — победил герой, 2 — монстр
+        int32_t finishedAt[laneCount]; // Раунд конца боя, 0 — бой не закончился
+        for (size_t lane = 0; lane < laneCount; ++lane)
+        {
+            heroHealth[lane] = hero.health;
+            monsterHealth[lane] = monster.health;
+            outcome[lane] = 0;
+            finishedAt[lane] = 0;
+        }
+        // Условия считаются масками из нулей и единиц во всех битах, чтобы в цикле не было ветвлений
+        int32_t running = -1;
+        for (int32_t r = 1; r <= maxRounds && running; ++r)
+        {
+            crits.next(critDraw);
+            poisons.next(poisonDraw);
+            running = 0;
+            for (size_t lane = 0; lane < laneCount; ++lane)
+            {
+                size_t stream = lane % streamCount;
+                uint32_t mirror = lane < streamCount ? 0u : ~0u;
+                int32_t active = -static_cast<int32_t>(outcome[lane] == 0);
+                int32_t heroHit = (critDraw[stream] ^ mirror) < critLimit ? heroBoosted : heroBase;
+                monsterHealth[lane] -= heroHit & active;
+                int32_t heroWon = active & -static_cast<int32_t>(monsterHealth[lane] <= 0);
+                int32_t monsterHit = (poisonDraw[stream] ^ mirror) < poisonLimit ? monsterBoosted : monsterBase;
+                heroHealth[lane] -= monsterHit & active & ~heroWon;
+                int32_t monsterWon = active & ~heroWon & -static_cast<int32_t>(heroHealth[lane] <= 0);
+                outcome[lane] |= (heroWon & 1) | (monsterWon & 2);
+                finishedAt[lane] |= (heroWon | monsterWon) & r;
+                running |= active & ~heroWon & ~monsterWon;
+            }
+        }
+        for (size_t lane = 0; lane < laneCount; ++lane)
+        {
+            tally.heroWins += outcome[lane] == 1;
+            ++tally.rounds[finishedAt[lane]];
+        }
+        for (size_t stream = 0; stream < streamCount; ++stream)
+        {
+            double pair = ((outcome[stream] == 1) + (outcome[stream + streamCount] == 1)) / 2.0;
+            tally.pairSum += pair;
+            tally.pairSquares += pair * pair;
+        }
+        tally.fights += laneCount;
+        tally.pairs += streamCount;
+    }
+}
+
+FightOdds monteCarloFightOdds(const FighterStats &hero, const FighterStats &monster, long long samples,
+                              unsigned threads, uint64_t seed = std::random_device{}())
+{
+    FightOdds odds;
+    long long maxRounds = fightRoundsBound(hero, monster);
+    if (maxRounds == 0)
+    {
+        odds.draw = 1;
+        return odds;
+    }
+    long long batches = std::max(1LL, (samples + static_cast<long long>(laneCount) - 1) / static_cast<long long>(laneCount));
+    batches = std::max(1LL, std::min(batches, monteCarloRoundBudget / maxRounds));
+    threads = static_cast<unsigned>(std::max(1LL, std::min<long long>(threads, batches)));
+    std::vector<MonteCarloTally> tallies(threads);
+    auto body = [&](unsigned id)
+    {
+        long long first = batches * id / threads;
+        long long last = batches * (id + 1) / threads;
+        uint64_t streamSeed = seed + id;
+        simulateFights(hero, monster, maxRounds, last - first, splitMix64(streamSeed), tallies[id]);
+    };
+    // Для одного потока запуск std::thread дороже самого расчёта
+    if (threads == 1)
+        body(0);
+    else
+        runThreads(threads, body);
+
+    MonteCarloTally total;
+    total.rounds.assign(maxRounds + 1, 0);
+    for (const MonteCarloTally &tally : tallies)
+    {
+        total.heroWins += tally.heroWins;
+        total.fights += tally.fights;
+        total.pairSum += tally.pairSum;
+        total.pairSquares += tally.pairSquares;
+        total.pairs += tally.pairs;
+        for (long long r = 0; r <= maxRounds; ++r)
+        {
+            total.rounds[r] += tally.rounds[r];
+        }
+    }
+
+    double fights = static_cast<double>(total.fights);
+    odds.samples = total.fights;
+    odds.heroWin = total.heroWins / fights;
+    odds.draw = total.rounds[0] / fights; // Бои, не уложившиеся в оценку раундов; при верной оценке их нет
+    odds.monsterWin = 1 - odds.heroWin - odds.draw;
+    odds.rounds.assign(maxRounds + 1, 0.0);
+    double roundSum = 0;
+    for (long long r = 1; r <= maxRounds; ++r)
+    {
+        odds.rounds[r] = total.rounds[r] / fights;
+        roundSum += static_cast<double>(r) * total.rounds[r];
+    }
+    double finished = fights - total.rounds[0];
+    odds.expectedRounds = finished > 0 ? roundSum / finished : 0;
+
+    double pairs = static_cast<double>(total.pairs);
+    double pairMean = total.pairSum / pairs;
+    double pairVariance = pairs > 1 ? std::max(0.0, (total.pairSquares - pairs * pairMean * pairMean) / (pairs - 1)) : 0;
+    double meanVariance = pairVariance / pairs;
+    odds.margin = 1.96 * std::sqrt(meanVariance);
+    double independentVariance = odds.heroWin * (1 - odds.heroWin) / fights;
+    odds.varianceReduction = meanVariance > 0 ? independentVariance / meanVariance : 1;
+    return odds;
+}
+
+// Для подбора противников: точное решение быстрее Монте-Карло при любой длине боя
+// (1200 раундов — меньше миллисекунды против ~0.1 с), Монте-Карло служит проверкой в --odds
+FightOdds estimateFight(const FighterStats &hero, const FighterStats &monster)
+{
+    return exactFightOdds(hero, monster);
+}
+
+FightOdds estimateFight(const Character &hero, const Monster &monster)
+{
+    return estimateFight(statsOf(hero), statsOf(monster));
+}
+
+int runStress(unsigned maxThreads, int fightsPerThread)
+{
+    battleLogEnabled = false;
+    const int endlessHealth = 1000000000; // Герой не должен погибнуть до конца замера
+    bool ok = true;
+
+    // Бои без общих сущностей: масштабирование по числу потоков
+    std::cout << "Disjoint fights (" << fightsPerThread << " per thread):\n";
+    double baseline = 0;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        std::vector<FightTally> tallies(threads);
+        double seconds = runThreads(threads, [&](unsigned id)
+                                    {
+                                        Character hero("Hero_" + std::to_string(id), endlessHealth, 20, 10);
+                                        for (int i = 0; i < fightsPerThread; ++i)
+                                        {
+                                            Monster goblin("Goblin", 50, 15, 5);
+                                            fightToEnd(hero, goblin, tallies[id]);
+                                        }
+                                    });
+        double rate = threads * fightsPerThread / seconds;
+        if (threads == 1)
+            baseline = rate;
+        std::cout << "  " << threads << " threads: " << rate << " fights/sec, speedup " << rate / baseline << "\n";
+    }
+
+    // Один герой во всех боях: его здоровье должно сойтись с суммой урона и лечения
+    {
+        Character hero("Hero", endlessHealth, 20, 10);
+        std::vector<FightTally> tallies(maxThreads);
+        runThreads(maxThreads, [&](unsigned id)
+                   {
+                       for (int i = 0; i < fightsPerThread; ++i)
+                       {
+                           Monster goblin("Goblin", 50, 15, 5);
+                           fightToEnd(hero, goblin, tallies[id]);
+                       }
+                   });
+        long long expected = endlessHealth;
+        for (const FightTally &tally : tallies)
+        {
+            expected += tally.healed - tally.damageToHero;
+        }
+        bool consistent = hero.getHealth() == expected;
+        ok = ok && consistent;
+        std::cout << "Shared hero: HP " << hero.getHealth() << ", expected " << expected
+                  << (consistent ? " - OK\n" : " - MISMATCH\n");
+    }
+
+    // Один монстр против всех: смертельный удар должен быть ровно один
+    {
+        const int bossHealth = 1000000;
+        Monster boss("Boss", bossHealth, 15, 5);
+        std::vector<FightTally> tallies(maxThreads);
+        runThreads(maxThreads, [&](unsigned id)
+                   {
+                       Character hero("Hero_" + std::to_string(id), endlessHealth, 20, 10);
+                       while (boss.isAlive())
+                       {
+                           Hit hit = hero.attackEnemy(boss);
+                           tallies[id].damageToMonster += hit.damage;
+                           tallies[id].kills += hit.killed;
+                       }
+                   });
+        long long damage = 0;
+        int kills = 0;
+        for (const FightTally &tally : tallies)
+        {
+            damage += tally.damageToMonster;
+            kills += tally.kills;
         }
+        bool consistent = kills == 1 && boss.getHealth() == bossHealth - damage;
+        ok = ok && consistent;
+        std::cout << "Shared monster: " << kills << " killing blow(s), HP " << boss.getHealth() << ", expected "
+                  << bossHealth - damage << (consistent ? " - OK\n" : " - MISMATCH\n");
+    }
+    return ok ? 0 : 1;
+}
+
+// Проверка оценщика: точное решение, Монте-Карло и повтор боёв через fightToEnd должны сходиться
+int runOdds(unsigned threads, long long samples)
+{
+    battleLogEnabled = false;
+    struct Matchup
+    {
+        FighterStats hero;
+        const char *monsterName;
+        FighterStats monster;
+    };
+    const FighterStats hero{100, 20, 10};
+    const Matchup matchups[] = {
+        {hero, "Goblin", {50, 15, 5}},
+        {hero, "Orc", {120, 24, 8}},
+        {hero, "Dragon", {150, 25, 20}},
+        {hero, "Troll", {400, 17, 4}},
+        {{6000, 20, 10}, "Titan", {24000, 15, 2}},
+    };
+    // Повторы через fightToEnd: до 20000 боёв, но не больше replayRounds раундов на противника,
+    // чтобы длинные бои проверялись за доли секунды
+    const long long maxReplays = 20000;
+    const long long replayRounds = 4000000;
+    bool ok = true;
+    auto microseconds = [](std::chrono::steady_clock::time_point started)
+    {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - started).count();
+    };
+
+    for (const Matchup &matchup : matchups)
+    {
+        std::cout << "Hero " << matchup.hero.health << "/" << matchup.hero.attack << "/" << matchup.hero.defense
+                  << " vs " << matchup.monsterName << " " << matchup.monster.health << "/" << matchup.monster.attack
+                  << "/" << matchup.monster.defense << " (up to " << fightRoundsBound(matchup.hero, matchup.monster)
+                  << " rounds):\n";
+
+        auto started = std::chrono::steady_clock::now();
+        FightOdds exact = exactFightOdds(matchup.hero, matchup.monster);
+        double exactTime = microseconds(started);
+        std::cout << "  exact:       hero wins " << exact.heroWin << ", draw " << exact.draw << ", avg rounds "
+                  << exact.expectedRounds << ", " << exactTime << " us\n";
+
+        started = std::chrono::steady_clock::now();
+        FightOdds estimated = monteCarloFightOdds(matchup.hero, matchup.monster, samples, threads);
+        double estimateTime = microseconds(started);
+        std::cout << "  monte carlo: hero wins " << estimated.heroWin << " +- " << estimated.margin << ", avg rounds "
+                  << estimated.expectedRounds << ", " << estimated.samples << " fights, variance "
+                  << estimated.varianceReduction << "x lower, " << estimateTime << " us\n";
+        // Четыре полуширины 95% интервала: случайный выход за них почти исключён. При вероятности около 0 или 1
+        // интервал вырождается в точку, тогда допуск — 3/n (правило трёх)
+        double tolerance = std::max(4 * estimated.margin, 3.0 / estimated.samples);
+        bool agrees = std::abs(exact.heroWin - estimated.heroWin) <= tolerance;
+        ok = ok && agrees;
+
+        if (exact.draw < 1)
+        {
+            long long replays = std::min(maxReplays, std::max(1LL, replayRounds / fightRoundsBound(matchup.hero, matchup.monster)));
+            FightTally tally;
+            for (long long i = 0; i < replays; ++i)
+            {
+                Character replayHero("Hero", matchup.hero.health, matchup.hero.attack, matchup.hero.defense);
+                Monster replayMonster(matchup.monsterName, matchup.monster.health, matchup.monster.attack,
+                                      matchup.monster.defense);
+                fightToEnd(replayHero, replayMonster, tally);
+            }
+            double replayed = static_cast<double>(tally.kills) / tally.fights;
+            double replayMargin = 1.96 * std::sqrt(std::max(0.0, exact.heroWin * (1 - exact.heroWin)) / tally.fights);
+            bool matches = std::abs(exact.heroWin - replayed) <= std::max(2 * replayMargin, 3.0 / tally.fights);
+            ok = ok && matches;
+            std::cout << "  replayed:    hero wins " << replayed << " in " << tally.fights << " fightToEnd runs"
+                      << (matches ? "\n" : " - MISMATCH\n");
+        }
+        std::cout << (agrees ? "  OK\n" : "  MISMATCH\n");
+    }
+    return ok ? 0 : 1;
+}
+
+// Сравнение виртуальной диспетчеризации и std::variant на count сущностях: каждая атакует
+// следующую и лечится. Указатели перемешаны, как у объектов, созданных в разное время игры;
+// варианты лежат подряд. Лог боя отключён, чтобы замерялись вызовы, а не вывод
+int runDispatchBenchmark(size_t count)
+{
+    if (count < 2)
+    {
+        std::cerr << "Error: --bench needs at least 2 entities" << std::endl;
+        return 2;
+    }
+    battleLogEnabled = false;
+    const int trials = 3;
+    const int endlessHealth = 1000000000;
+    std::vector<std::unique_ptr<Entity>> owned;
+    std::vector<EntityValue> values;
+    owned.reserve(count);
+    values.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i % 2 == 0)
+        {
+            owned.push_back(std::make_unique<Character>("Hero", endlessHealth, 20, 10));
+            values.emplace_back(Character("Hero", endlessHealth, 20, 10));
+        }
+        else
+        {
+            owned.push_back(std::make_unique<Monster>("Goblin", endlessHealth, 15, 5));
+            values.emplace_back(Monster("Goblin", endlessHealth, 15, 5));
+        }
+    }
+    std::shuffle(owned.begin(), owned.end(), std::minstd_rand(1));
+    std::vector<Entity *> pointers;
+    pointers.reserve(count);
+    for (const auto &entity : owned)
+    {
+        pointers.push_back(entity.get());
+    }
+
+    auto seconds = [](std::chrono::steady_clock::time_point started)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    };
+    double virtualBest = 1e30, variantBest = 1e30;
+    for (int trial = 0; trial < trials; ++trial)
+    {
+        auto started = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i)
+        {
+            pointers[i]->attackEnemy(*pointers[(i + 1) % count]);
+            pointers[i]->heal(1);
+        }
+        virtualBest = std::min(virtualBest, seconds(started));
+
+        started = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i)
+        {
+            attackEnemy(values[i], values[(i + 1) % count]);
+            heal(values[i], 1);
+        }
+        variantBest = std::min(variantBest, seconds(started));
+    }
+    std::cout << "Attack loop over " << count << " entities, best of " << trials << " trials:\n"
+              << "Virtual dispatch (Entity *): " << count / virtualBest << " attacks/sec\n"
+              << "std::variant by value: " << count / variantBest << " attacks/sec" << std::endl;
+    return 0;
+}
+
+// Запуск: 7_2 [--max-speed] [--ticks N] | --stress [--threads N] [--fights N] | --odds [--threads N] [--samples N]
+//        | --bench [--entities N]
+// --max-speed выполняет тики без ожидания, --ticks останавливает цикл через N тиков,
+// --stress запускает параллельные бои и проверку согласованности здоровья,
+// --odds сравнивает точную и Монте-Карло оценки исхода боя с повтором боёв,
+// --bench сравнивает виртуальные вызовы и std::variant на N сущностях
+int main(int argc, char *argv[]) {
+    srand(static_cast<unsigned>(time(0)));
+    bool maxSpeed = false;
+    bool stress = false;
+    bool odds = false;
+    bool bench = false;
+    size_t entities = 1000000;
+    long long samples = 1 << 14;
+    unsigned long long tickLimit = 0;
+    unsigned threads = std::max(2u, std::thread::hardware_concurrency());
+    int fights = 20000;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--max-speed")
+            maxSpeed = true;
+        else if (arg == "--stress")
+            stress = true;
+        else if (arg == "--odds")
+            odds = true;
+        else if (arg == "--bench")
+            bench = true;
+        else if (arg == "--entities" && i + 1 < argc)
+            entities = std::stoul(argv[++i]);
+        else if (arg == "--samples" && i + 1 < argc)
+            samples = std::max(1LL, std::stoll(argv[++i]));
+        else if (arg == "--ticks" && i + 1 < argc)
+            tickLimit = std::stoull(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--fights" && i + 1 < argc)
+            fights = std::stoi(argv[++i]);
+    }
+    if (stress)
+    {
+        return runStress(threads, fights);
+    }
+    if (odds)
+    {
+        return runOdds(threads, samples);
+    }
+    if (bench)
+    {
+        return runDispatchBenchmark(entities);
+    }
+
+    FixedStepLoop loop(tickStep, maxSpeed);
+    Arena arena(loop);
+    if (tickLimit > 0)
+    {
+        loop.timers().schedule(tickLimit, [&loop] { loop.stop(); });
     }
-    std::cout << "Game Over!\n";
+    loop.start();
+    loop.join();
+    loop.report(std::cout);
     return 0;
 }
@@ -1,5 +1,238 @@
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <fstream>
+#include <algorithm>
+#include <thread>
+#include "../common/Bulk_import.h"
+#include "../common/Text_buffer.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PERSON_SSE2 1
+#endif
+
+// Ошибки проверки записи, по биту на правило
+enum PersonError : uint8_t {
+    NameEmpty = 1 << 0,
+    NameInvalid = 1 << 1,    // Управляющие символы
+    AgeOutOfRange = 1 << 2,
+    EmailNoAt = 1 << 3,
+    EmailInvalid = 1 << 4,   // Не одна '@', пустая локальная часть, домен без точки, пробелы или не ASCII
+    AddressEmpty = 1 << 5,
+    AddressInvalid = 1 << 6  // Управляющие символы
+};
+
+const int minAge = 0;
+const int maxAge = 120;
+
+// Названия ошибок маски через запятую, для файла отклонённых записей
+inline std::string personErrorNames(uint8_t errors) {
+    static const char* const names[] = {"empty name", "invalid name", "age out of range", "email without @",
+                                        "invalid email", "empty address", "invalid address"};
+    std::string result;
+    for (int bit = 0; bit < 7; ++bit) {
+        if (errors & (1 << bit)) {
+            if (!result.empty()) {
+                result += ',';
+            }
+            result += names[bit];
+        }
+    }
+    return result;
+}
+
+// Что нашлось в строке за один проход
+struct TextScan {
+    bool control = false;  // Байты 0x00-0x1F и 0x7F
+    bool nonAscii = false; // Байты 0x80-0xFF
+    bool space = false;
+    size_t atCount = 0;
+    size_t firstAt = std::string_view::npos;
+    size_t lastDot = std::string_view::npos;
+};
+
+inline void scanScalar(const char* data, size_t begin, size_t end, TextScan& scan) {
+    for (size_t i = begin; i < end; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        scan.control |= c < 0x20 || c == 0x7F;
+        scan.nonAscii |= c >= 0x80;
+        scan.space |= c == ' ';
+        if (c == '@' && scan.atCount++ == 0) {
+            scan.firstAt = i;
+        }
+        if (c == '.') {
+            scan.lastDot = i;
+        }
+    }
+}
+
+// Строка просматривается по 16 байт; '@' и '.' встречаются редко, поэтому их позиции
+// уточняются скалярно только в блоках, где они есть. Хвост короче 16 байт — скалярно
+inline TextScan scanText(std::string_view text, bool simd = true) {
+    TextScan scan;
+    size_t i = 0;
+#ifdef PERSON_SSE2
+    if (simd) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i space = _mm_set1_epi8(' ');
+        const __m128i del = _mm_set1_epi8(0x7F);
+        const __m128i at = _mm_set1_epi8('@');
+        const __m128i dot = _mm_set1_epi8('.');
+        int control = 0, nonAscii = 0, spaces = 0;
+        for (; i + 16 <= text.size(); i += 16) {
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i));
+            __m128i high = _mm_cmplt_epi8(c, zero); // Байты >= 0x80 как знаковые отрицательны
+            nonAscii |= _mm_movemask_epi8(high);
+            control |= _mm_movemask_epi8(
+                _mm_or_si128(_mm_andnot_si128(high, _mm_cmplt_epi8(c, space)), _mm_cmpeq_epi8(c, del)));
+            spaces |= _mm_movemask_epi8(_mm_cmpeq_epi8(c, space));
+            if (_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(c, at), _mm_cmpeq_epi8(c, dot)))) {
+                TextScan block;
+                scanScalar(text.data(), i, i + 16, block);
+                if (block.atCount > 0 && scan.atCount == 0) {
+                    scan.firstAt = block.firstAt;
+                }
+                scan.atCount += block.atCount;
+                if (block.lastDot != std::string_view::npos) {
+                    scan.lastDot = block.lastDot;
+                }
+            }
+        }
+        scan.control = control != 0;
+        scan.nonAscii = nonAscii != 0;
+        scan.space = spaces != 0;
+    }
+#else
+    (void)simd;
+#endif
+    scanScalar(text.data(), i, text.size(), scan);
+    return scan;
+}
+
+inline uint8_t validateName(std::string_view name, bool simd = true) {
+    if (name.empty()) {
+        return NameEmpty;
+    }
+    return scanText(name, simd).control ? NameInvalid : 0;
+}
+
+inline uint8_t validateAge(int age) {
+    return age >= minAge && age <= maxAge ? 0 : AgeOutOfRange;
+}
+
+// Адрес проверяется упрощённо: ровно одна '@', непустая локальная часть,
+// в домене есть точка не в начале и не в конце, только печатные ASCII-символы без пробелов
+inline uint8_t validateEmail(std::string_view email, bool simd = true) {
+    TextScan scan = scanText(email, simd);
+    if (scan.atCount == 0) {
+        return EmailNoAt;
+    }
+    bool valid = scan.atCount == 1 && scan.firstAt > 0 && scan.lastDot != std::string_view::npos &&
+                 scan.lastDot > scan.firstAt + 1 && scan.lastDot + 1 < email.size() &&
+                 !scan.control && !scan.nonAscii && !scan.space;
+    return valid ? 0 : EmailInvalid;
+}
+
+inline uint8_t validateAddress(std::string_view address, bool simd = true) {
+    if (address.empty()) {
+        return AddressEmpty;
+    }
+    return scanText(address, simd).control ? AddressInvalid : 0;
+}
+
+// Строковый столбец: все значения подряд в одном буфере, ends[i] — конец i-го значения
+class StringColumn {
+private:
+    std::string chars;
+    std::vector<uint32_t> ends;
+
+public:
+    void reserve(size_t count, size_t bytes) {
+        ends.reserve(count);
+        chars.reserve(bytes);
+    }
+
+    void push_back(std::string_view value) {
+        if (chars.size() + value.size() > UINT32_MAX) {
+            throw std::length_error("String column is larger than 4 GB");
+        }
+        chars.append(value.data(), value.size());
+        ends.push_back(static_cast<uint32_t>(chars.size()));
+    }
+
+    size_t size() const {
+        return ends.size();
+    }
+
+    std::string_view operator[](size_t i) const {
+        size_t begin = i == 0 ? 0 : ends[i - 1];
+        return std::string_view(chars.data() + begin, ends[i] - begin);
+    }
+};
+
+// Записи по столбцам: проверка идёт по одному полю всех записей подряд
+struct PersonColumns {
+    StringColumn names;
+    std::vector<int> ages;
+    StringColumn emails;
+    StringColumn addresses;
+
+    size_t size() const {
+        return ages.size();
+    }
+};
+
+// errors[i] — маска PersonError записи i; ничего не печатает
+inline void validatePeople(const PersonColumns& people, std::vector<uint8_t>& errors, bool simd = true) {
+    size_t count = people.size();
+    if (people.names.size() != count || people.emails.size() != count || people.addresses.size() != count) {
+        throw std::invalid_argument("Person columns have different lengths");
+    }
+    errors.assign(count, 0);
+    size_t i = 0;
+#ifdef PERSON_SSE2
+    if (simd) {
+        // Возраст: четыре сравнения за раз, (age < min) | (age > max)
+        const __m128i below = _mm_set1_epi32(minAge);
+        const __m128i above = _mm_set1_epi32(maxAge);
+        for (; i + 4 <= count; i += 4) {
+            __m128i age = _mm_loadu_si128(reinterpret_cast<const __m128i*>(people.ages.data() + i));
+            int bad = _mm_movemask_ps(_mm_castsi128_ps(
+                _mm_or_si128(_mm_cmplt_epi32(age, below), _mm_cmpgt_epi32(age, above))));
+            for (int lane = 0; bad; ++lane, bad >>= 1) {
+                if (bad & 1) {
+                    errors[i + lane] = AgeOutOfRange;
+                }
+            }
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        errors[i] = validateAge(people.ages[i]);
+    }
+    for (i = 0; i < count; ++i) {
+        errors[i] |= validateName(people.names[i], simd);
+    }
+    for (i = 0; i < count; ++i) {
+        errors[i] |= validateEmail(people.emails[i], simd);
+    }
+    for (i = 0; i < count; ++i) {
+        errors[i] |= validateAddress(people.addresses[i], simd);
+    }
+}
+
+// Строка "Name: ..., Age: ..., Email: ..., Address: ..." выводится одним write без сброса потока
+inline void displayPerson(std::string_view name, int age, std::string_view email, std::string_view address) {
+    TextBuffer &out = TextBuffer::local();
+    out << "Name: " << name << ", Age: " << age << ", Email: " << email << ", Address: " << address << '\n';
+    out.writeTo(std::cout);
+}
 
 class Person {
 private:
@@ -27,15 +260,18 @@ public:
 
     // Сеттеры
     void setName(const std::string& newName) {
-        if (!newName.empty()) {
+        uint8_t errors = validateName(newName);
+        if (!errors) {
             name = newName;
-        } else {
+        } else if (errors & NameEmpty) {
             std::cerr << "Error: Name cannot be empty!" << std::endl;
+        } else {
+            std::cerr << "Error: Name contains control characters!" << std::endl;
         }
     }
 
     void setAge(int newAge) {
-        if (newAge >= 0 && newAge <= 120) {
+        if (!validateAge(newAge)) {
             age = newAge;
         } else {
             std::cerr << "Error: Age must be between 0 and 120!" << std::endl;
@@ -43,26 +279,414 @@ public:
     }
 
     void setEmail(const std::string& newEmail) {
-        if (newEmail.find('@') != std::string::npos) {
+        if (!validateEmail(newEmail)) {
             email = newEmail;
         } else {
             std::cerr << "Error: Invalid email format!" << std::endl;
         }
     }
     void setAddress(const std::string& newAddress){
-        if (!address.empty()){
+        uint8_t errors = validateAddress(newAddress);
+        if (!errors){
             address = newAddress;
-        }else{
+        }else if (errors & AddressEmpty){
             std::cerr <<"Error: address cannot be empty!"<<std::endl;
+        }else{
+            std::cerr <<"Error: address contains control characters!"<<std::endl;
         }
     }
     // Метод для вывода информации о человеке
     void displayInfo() const {
-        std::cout << "Name: " << name << ", Age: " << age << ", Email: " << email << ", Address: "<< address << std::endl;
+        displayPerson(name, age, email, address);
+    }
+};
+
+// Компактное хранилище записей для чтения: строки всех записей лежат подряд в одном буфере,
+// запись хранит смещение и длины полей, возраст — отдельный столбец uint8_t.
+// Доступ по string_view не выделяет память; getName и другие геттеры копируют, как у Person
+class PersonStore {
+private:
+    struct Record {
+        uint32_t offset; // Начало имени; за ним email и адрес
+        uint16_t nameLength;
+        uint16_t emailLength;
+        uint16_t addressLength;
+    };
+
+    std::string arena;
+    std::vector<Record> records;
+    std::vector<uint8_t> ages;
+
+public:
+    void reserve(size_t count, size_t bytes) {
+        records.reserve(count);
+        ages.reserve(count);
+        arena.reserve(bytes);
+    }
+
+    // Проверяет запись теми же правилами, что и сеттеры Person; возвращает маску PersonError,
+    // запись добавляется только при нулевой маске
+    uint8_t add(std::string_view name, int age, std::string_view email, std::string_view address) {
+        uint8_t errors = validateName(name) | validateAge(age) | validateEmail(email) | validateAddress(address);
+        if (errors) {
+            return errors;
+        }
+        if (name.size() > UINT16_MAX || email.size() > UINT16_MAX || address.size() > UINT16_MAX) {
+            throw std::length_error("Person field is longer than 65535 bytes");
+        }
+        if (arena.size() + name.size() + email.size() + address.size() > UINT32_MAX) {
+            throw std::length_error("Person store is larger than 4 GB");
+        }
+        records.push_back(Record{static_cast<uint32_t>(arena.size()), static_cast<uint16_t>(name.size()),
+                                 static_cast<uint16_t>(email.size()), static_cast<uint16_t>(address.size())});
+        ages.push_back(static_cast<uint8_t>(age));
+        arena.append(name.data(), name.size());
+        arena.append(email.data(), email.size());
+        arena.append(address.data(), address.size());
+        return 0;
+    }
+
+    size_t size() const {
+        return records.size();
+    }
+
+    // Дописывает записи других хранилищ по порядку: так сливаются результаты потоков импорта.
+    // Место выделяется сразу, части копируются на свои места параллельно
+    void append(const std::vector<PersonStore>& parts, size_t threads) {
+        std::vector<size_t> recordStart(parts.size()), arenaStart(parts.size());
+        size_t recordCount = records.size(), arenaSize = arena.size();
+        for (size_t k = 0; k < parts.size(); ++k) {
+            recordStart[k] = recordCount;
+            arenaStart[k] = arenaSize;
+            recordCount += parts[k].records.size();
+            arenaSize += parts[k].arena.size();
+        }
+        if (arenaSize > UINT32_MAX) {
+            throw std::length_error("Person store is larger than 4 GB");
+        }
+        records.resize(recordCount);
+        ages.resize(recordCount);
+        arena.resize(arenaSize);
+        runParallel(parts.size(), threads, [&](size_t k) {
+            const PersonStore& part = parts[k];
+            uint32_t shift = static_cast<uint32_t>(arenaStart[k]);
+            for (size_t i = 0; i < part.records.size(); ++i) {
+                Record record = part.records[i];
+                record.offset += shift;
+                records[recordStart[k] + i] = record;
+            }
+            std::copy(part.ages.begin(), part.ages.end(), ages.begin() + recordStart[k]);
+            std::copy(part.arena.begin(), part.arena.end(), arena.begin() + arenaStart[k]);
+        });
+    }
+
+    // Занятая память без учёта запаса ёмкости
+    size_t bytes() const {
+        return arena.size() + records.size() * sizeof(Record) + ages.size();
+    }
+
+    std::string_view name(size_t i) const {
+        return std::string_view(arena.data() + records[i].offset, records[i].nameLength);
+    }
+    int age(size_t i) const {
+        return ages[i];
+    }
+    std::string_view email(size_t i) const {
+        const Record& record = records[i];
+        return std::string_view(arena.data() + record.offset + record.nameLength, record.emailLength);
+    }
+    std::string_view address(size_t i) const {
+        const Record& record = records[i];
+        return std::string_view(arena.data() + record.offset + record.nameLength + record.emailLength,
+                                record.addressLength);
+    }
+
+    std::string getName(size_t i) const {
+        return std::string(name(i));
+    }
+    int getAge(size_t i) const {
+        return age(i);
+    }
+    std::string getEmail(size_t i) const {
+        return std::string(email(i));
+    }
+    std::string getAddress(size_t i) const {
+        return std::string(address(i));
+    }
+
+    void displayInfo(size_t i) const {
+        displayPerson(name(i), age(i), email(i), address(i));
     }
 };
 
-int main() {
+// Отклонённая строка; номер считается от начала куска и сдвигается при слиянии
+struct Reject {
+    size_t line;
+    std::string_view text;
+    const char* problem; // Ошибка разбора или nullptr, тогда причина в errors
+    uint8_t errors;
+};
+
+// Кусок файла из целых строк, который разбирает один поток
+struct ImportChunk {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    PersonStore people;
+    std::vector<Reject> rejects;
+    size_t lines = 0;
+};
+
+inline void importChunk(ImportChunk& chunk, ImportFormat format) {
+    static const std::string_view keys[] = {"name", "age", "email", "address"};
+    std::string_view fields[4];
+    std::string scratch[5];
+    chunk.people.reserve((chunk.end - chunk.begin) / 64, chunk.end - chunk.begin);
+    chunk.lines = forEachLine(chunk.begin, chunk.end, [&](size_t number, std::string_view line) {
+        const char* problem = nullptr;
+        if (format == ImportFormat::Csv) {
+            if (!splitCsv(line, fields, 4, scratch)) {
+                problem = "expected 4 CSV fields";
+            }
+        } else {
+            int found = parseJson(line, keys, 4, fields, scratch);
+            if (found < 0) {
+                problem = "malformed JSON";
+            } else if (found != 0xF) {
+                problem = "missing field";
+            }
+        }
+        int age = 0;
+        if (!problem && !parseInt(fields[1], age)) {
+            problem = "age is not a number";
+        }
+        if (!problem && std::max({fields[0].size(), fields[2].size(), fields[3].size()}) > UINT16_MAX) {
+            problem = "field is too long";
+        }
+        if (problem) {
+            chunk.rejects.push_back(Reject{number, line, problem, 0});
+            return;
+        }
+        uint8_t errors = chunk.people.add(fields[0], age, fields[2], fields[3]);
+        if (errors) {
+            chunk.rejects.push_back(Reject{number, line, nullptr, errors});
+        }
+    });
+}
+
+// Массовый импорт CSV (name,age,email,address; заголовок "name,..." пропускается) или JSON Lines
+// ({"name": ..., "age": ..., "email": ..., "address": ...}) в store; формат определяется по первому символу.
+// Файл отображается в память, поля разбираются без копирования, куски из целых строк
+// обрабатываются в threads потоках и сливаются по порядку. Отклонённые строки пишутся
+// в rejectFile как "номер строки<TAB>причина<TAB>исходная строка"
+inline ImportStats importPeople(const std::string& filename, PersonStore& store, const std::string& rejectFile,
+                                size_t threads) {
+    MappedFile file(filename, "import");
+    ImportText text = detectImport(file, "name,");
+    std::vector<ImportChunk> chunks;
+    for (const auto& range : splitLineChunks(text, threads)) {
+        chunks.emplace_back();
+        chunks.back().begin = range.first;
+        chunks.back().end = range.second;
+    }
+    runParallel(chunks.size(), threads, [&](size_t k) { importChunk(chunks[k], text.format); });
+
+    std::ofstream rejects(rejectFile, std::ios::binary);
+    if (!rejects) {
+        throw std::runtime_error("Cannot open reject file");
+    }
+    ImportStats stats;
+    std::vector<PersonStore> parts(chunks.size());
+    for (size_t k = 0; k < chunks.size(); ++k) {
+        parts[k] = std::move(chunks[k].people);
+        stats.imported += parts[k].size();
+    }
+    store.append(parts, threads);
+    parts.clear();
+    size_t line = text.headerLines;
+    for (const ImportChunk& chunk : chunks) {
+        for (const Reject& reject : chunk.rejects) {
+            rejects << line + reject.line << '\t' << (reject.problem ? reject.problem : personErrorNames(reject.errors))
+                    << '\t' << reject.text << '\n';
+        }
+        stats.rejected += chunk.rejects.size();
+        line += chunk.lines;
+    }
+    if (!rejects.flush()) {
+        throw std::runtime_error("Failed to write reject file");
+    }
+    return stats;
+}
+
+// Замер импорта: генерирует CSV и JSON Lines по rows записей (каждая сотая с ошибкой) и загружает их
+void runImportBenchmark(size_t rows, size_t threads) {
+    for (ImportFormat format : {ImportFormat::Csv, ImportFormat::JsonLines}) {
+        bool csv = format == ImportFormat::Csv;
+        const std::string filename = csv ? "import_bench.csv" : "import_bench.jsonl";
+        {
+            std::ofstream out(filename, std::ios::binary);
+            std::string buffer;
+            if (csv) {
+                buffer = "name,age,email,address\n";
+            }
+            for (size_t i = 0; i < rows; ++i) {
+                std::string number = std::to_string(i);
+                bool broken = i % 100 == 99;
+                std::string age = broken && i % 200 == 99 ? "150" : std::to_string(i % 100);
+                std::string email = "user" + number + (broken && i % 200 == 199 ? "" : "@example.com");
+                if (csv) {
+                    buffer += "Person " + number + "," + age + "," + email + ",\"Rostov-on-Don, Gagarina st. " +
+                              number + "\"\n";
+                } else {
+                    buffer += "{\"name\": \"Person " + number + "\", \"age\": " + age + ", \"email\": \"" + email +
+                              "\", \"address\": \"Rostov-on-Don, Gagarina st. " + number + "\"}\n";
+                }
+                if (buffer.size() >= (1 << 20)) {
+                    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                    buffer.clear();
+                }
+            }
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        }
+
+        PersonStore store;
+        auto started = std::chrono::steady_clock::now();
+        ImportStats stats = importPeople(filename, store, "import_bench.rejects", threads);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        std::remove(filename.c_str());
+        std::remove("import_bench.rejects");
+        if (stats.imported + stats.rejected != rows || store.size() != stats.imported) {
+            throw std::runtime_error("Import lost records");
+        }
+        std::cout << (csv ? "CSV" : "JSON Lines") << ": " << rows / seconds << " rows/sec, imported "
+                  << stats.imported << ", rejected " << stats.rejected << std::endl;
+    }
+}
+
+// Замер чтения: проход отчёта по всем записям через копирующие геттеры Person
+// и через string_view из PersonStore
+void runReadBenchmark(size_t rows) {
+    std::vector<Person> people(rows);
+    PersonStore store;
+    store.reserve(rows, rows * 64);
+    for (size_t i = 0; i < rows; ++i) {
+        std::string number = std::to_string(i);
+        std::string name = "Person " + number;
+        std::string email = "user" + number + "@example.com";
+        std::string address = "Rostov-on-Don, Gagarina st. " + number;
+        int age = static_cast<int>(i % 100);
+        people[i].setName(name);
+        people[i].setAge(age);
+        people[i].setEmail(email);
+        people[i].setAddress(address);
+        store.add(name, age, email, address);
+    }
+
+    const int passes = 5;
+    size_t checksum[2] = {0, 0};
+    double seconds[2];
+    auto started = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        for (const Person& person : people) {
+            checksum[0] += person.getName().size() + person.getEmail().size() + person.getAddress().size() +
+                           static_cast<size_t>(person.getAge());
+        }
+    }
+    seconds[0] = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    started = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        for (size_t i = 0; i < store.size(); ++i) {
+            checksum[1] += store.name(i).size() + store.email(i).size() + store.address(i).size() +
+                           static_cast<size_t>(store.age(i));
+        }
+    }
+    seconds[1] = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    if (checksum[0] != checksum[1]) {
+        throw std::runtime_error("Layouts returned different data");
+    }
+
+    // Строки длиннее встроенного буфера std::string лежат в куче отдельно (оценка снизу)
+    size_t personBytes = rows * sizeof(Person);
+    const size_t inlineCapacity = std::string().capacity();
+    for (const Person& person : people) {
+        for (size_t length : {person.getName().size(), person.getEmail().size(), person.getAddress().size()}) {
+            if (length > inlineCapacity) {
+                personBytes += length + 1;
+            }
+        }
+    }
+    std::cout << "Person getters: " << rows * passes / seconds[0] << " records/sec, "
+              << personBytes / double(1 << 20) << " MB\n"
+              << "PersonStore views: " << rows * passes / seconds[1] << " records/sec, "
+              << store.bytes() / double(1 << 20) << " MB" << std::endl;
+}
+
+// Замер пакетной проверки на сгенерированных записях; примерно каждая сотая запись с ошибкой
+void runBenchmark(size_t rows) {
+    PersonColumns people;
+    people.names.reserve(rows, rows * 16);
+    people.ages.reserve(rows);
+    people.emails.reserve(rows, rows * 24);
+    people.addresses.reserve(rows, rows * 40);
+    std::string value;
+    for (size_t i = 0; i < rows; ++i) {
+        std::string number = std::to_string(i);
+        bool broken = i % 100 == 99;
+        people.names.push_back(broken && i % 300 == 99 ? std::string() : "Person " + number);
+        people.ages.push_back(broken && i % 300 == 199 ? 150 : static_cast<int>(i % 100));
+        value = "user" + number + (broken && i % 300 == 299 ? "example.com" : "@example.com");
+        people.emails.push_back(value);
+        value = "Rostov-on-Don, Gagarina st. " + number;
+        people.addresses.push_back(value);
+    }
+
+    std::vector<uint8_t> errors, scalarErrors;
+    for (bool simd : {true, false}) {
+        std::vector<uint8_t>& result = simd ? errors : scalarErrors;
+        auto started = std::chrono::steady_clock::now();
+        validatePeople(people, result, simd);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        size_t invalid = 0;
+        for (uint8_t mask : result) {
+            invalid += mask != 0;
+        }
+#ifdef PERSON_SSE2
+        const char* mode = simd ? "SSE2" : "scalar";
+#else
+        const char* mode = "scalar";
+#endif
+        std::cout << mode << ": " << rows / seconds << " records/sec, invalid: " << invalid << std::endl;
+    }
+    if (errors != scalarErrors) {
+        throw std::runtime_error("SSE2 and scalar validation disagree");
+    }
+}
+
+// Запуск: 8_0 [--bench [записей] | --read-bench [записей] | --import файл [отклонённые] [потоков]
+//             | --import-bench [записей] [потоков]]
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--bench" || mode == "--read-bench" || mode == "--import" || mode == "--import-bench") {
+        try {
+            size_t threads = std::max(1u, std::thread::hardware_concurrency());
+            if (mode == "--bench")
+                runBenchmark(argc > 2 ? std::stoul(argv[2]) : 10000000);
+            else if (mode == "--read-bench")
+                runReadBenchmark(argc > 2 ? std::stoul(argv[2]) : 1000000);
+            else if (mode == "--import-bench")
+                runImportBenchmark(argc > 2 ? std::stoul(argv[2]) : 2000000, argc > 3 ? std::stoul(argv[3]) : threads);
+            else if (argc > 2) {
+                PersonStore store;
+                ImportStats stats = importPeople(argv[2], store, argc > 3 ? argv[3] : std::string(argv[2]) + ".rejects",
+                                                 argc > 4 ? std::stoul(argv[4]) : threads);
+                std::cout << "Imported " << stats.imported << " records, rejected " << stats.rejected << std::endl;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
     Person person;
 
     // Устанавливаем значения с помощью сеттеров
@@ -81,10 +705,17 @@ int main() {
     person.setName(""); // Ошибка: имя не может быть пустым
     person.setAge(150); // Ошибка: возраст должен быть от 0 до 120
     person.setEmail("invalid-email"); // Ошибка: некорректный email
-    person.setAddress(""); // Ошибка: некорректный email
+    person.setAddress(""); // Ошибка: адрес не может быть пустым
 
     // Выводим информацию о человеке
     person.displayInfo();
 
+    // Та же запись в компактном хранилище; некорректная запись не добавляется
+    PersonStore store;
+    store.add(person.getName(), person.getAge(), person.getEmail(), person.getAddress());
+    uint8_t errors = store.add("", 150, "invalid-email", "");
+    std::cout << "Rejected record, error mask: " << static_cast<int>(errors) << std::endl;
+    store.displayInfo(0);
+
     return 0;
 }
@@ -5,46 +5,172 @@
 #include <fstream>
 #include <stdexcept>
 #include <iostream>
+#include <ctime>
+#include <random>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <sstream>
+#include <unordered_map>
+#include <string_view>
+#include <array>
+#include <algorithm>
+#include <charconv>
+#include <type_traits>
+#include "Save_format.h"
+#include "../common/Text_buffer.h"
 
 class Monster;
 
+// Поток вывода игры для текущего потока: по умолчанию консоль, сервер подменяет его буфером сессии
+inline std::ostream *&gameOutput()
+{
+    thread_local std::ostream *out = &std::cout;
+    return out;
+}
+
+inline std::ostream &gameOut()
+{
+    return *gameOutput();
+}
+
 template<typename T>
 class Logger {
 private:
+    std::string filename;
     std::ofstream log_file;
+    bool buffered;
+    std::ostringstream pending; // Строки, ещё не дописанные в файл (буферизованный режим)
 
     std::string getTimestamp() const {
         std::time_t now = std::time(nullptr);
-        std::string time = std::ctime(&now);
-        if (!time.empty() && time.back() == '\n') {
-            time.pop_back();
-        }
+        std::tm local;
+#ifdef _WIN32
+        localtime_s(&local, &now);
+#else
+        localtime_r(&now, &local);
+#endif
+        char time[32];
+        std::strftime(time, sizeof(time), "%a %b %e %H:%M:%S %Y", &local);
         return time;
     }
 
 public:
-    Logger(const std::string& filename) {
+    // В буферизованном режиме файл открывается только на время записи накопленных строк,
+    // поэтому тысячи логгеров не держат открытыми тысячи файлов
+    Logger(const std::string& filename, bool buffered = false) : filename(filename), buffered(buffered) {
         log_file.open(filename, std::ios::app);
         if (!log_file.is_open()) {
             throw std::runtime_error("Failed to open log file: " + filename);
         }
+        if (buffered) {
+            log_file.close();
+        }
     }
 
     ~Logger() {
+        try {
+            flush();
+        } catch (const std::exception &) {
+        }
         if (log_file.is_open()) {
             log_file.close();
         }
     }
 
     void log(const T& message) {
+        if (buffered) {
+            pending << "[" << getTimestamp() << "] " << message << "\n";
+            if (pending.tellp() >= 4096) {
+                flush();
+            }
+            return;
+        }
         if (!log_file.is_open()) {
             throw std::runtime_error("Log file is not open");
         }
         log_file << "[" << getTimestamp() << "] " << message << "\n";
         log_file.flush();
     }
+
+    void flush() {
+        if (!buffered || pending.tellp() <= 0) {
+            return;
+        }
+        std::ofstream out(filename, std::ios::app);
+        if (!out) {
+            throw std::runtime_error("Failed to open log file: " + filename);
+        }
+        out << pending.str();
+        pending.str("");
+    }
+};
+
+// Событие изменения состояния игры, записывается в журнал сохранения
+struct GameEvent
+{
+    enum Kind : uint8_t
+    {
+        SetHp,
+        GainExp,
+        AddItem,
+        RemoveItem,
+        SpawnMonster,
+        ReleaseMonster
+    };
+
+    uint64_t seq;
+    Kind kind;
+    int32_t target; // 0 — игрок, иначе id монстра
+    int32_t value;  // Здоровье, опыт, количество предметов или тип монстра
+    std::string item;
+
+    void save(SaveWriter &out) const;
+    void load(SaveReader &in);
+};
+
+// Накапливает события с момента последней передачи их на запись
+class EventLog
+{
+private:
+    std::vector<GameEvent> events;
+    uint64_t last_seq = 0;
+
+public:
+    void record(GameEvent::Kind kind, int32_t target, int32_t value, const std::string &item = std::string())
+    {
+        events.push_back(GameEvent{++last_seq, kind, target, value, item});
+    }
+    std::vector<GameEvent> takeEvents()
+    {
+        std::vector<GameEvent> taken;
+        taken.swap(events);
+        return taken;
+    }
+    uint64_t lastSeq() const { return last_seq; }
+    void restart(uint64_t seq)
+    {
+        events.clear();
+        last_seq = seq;
+    }
 };
 
+// Архетип героя: стартовые характеристики и прибавка за уровень
+struct CharacterArchetype
+{
+    int hp;
+    int attack;
+    int defense;
+    int hp_per_level;
+    int attack_per_level;
+    int defense_per_level;
+};
+
+inline constexpr CharacterArchetype hero_archetype{100, 10, 5, 20, 5, 2};
+
 class Character
 {
 protected:
@@ -55,127 +181,544 @@ protected:
     int defense;
     int level;
     int experience;
+    uint32_t stat_version; // Меняется при любом изменении атаки, защиты или максимума здоровья
+    EventLog *journal = nullptr;
 
 public:
-    Character(const std::string &name, int hp = 100, int attack = 10, int defense = 5);
+    Character(const std::string &name, int hp = hero_archetype.hp, int attack = hero_archetype.attack,
+              int defense = hero_archetype.defense);
     void attackTarget(Monster& target);
     void heal(int amount);
     void gainExp(int exp);
+    int applyExp(int exp);
     void displayInfo() const;
 
     int getDefense() const {return defense; }
     int getHp() const { return hp; }
+    int getMaxHp() const { return max_hp; }
+    uint32_t getStatVersion() const { return stat_version; }
     std::string getName() const { return name; }
 
-    void setHp(int new_hp) {hp = new_hp; };
-    void save(std::ofstream &out) const;
-    void load(std::ifstream &in);
+    void setJournal(EventLog *log) { journal = log; }
+    void setHp(int new_hp)
+    {
+        hp = new_hp;
+        if (journal)
+            journal->record(GameEvent::SetHp, 0, hp);
+    };
+    void save(SaveWriter &out) const;
+    void load(SaveReader &in);
 };
 
-class Monster
+// Шаблон (flyweight) типа монстра: имя и базовые характеристики хранятся один раз на тип
+struct MonsterTemplate
 {
-protected:
-    std::string name;
+    uint8_t type_id; // Индекс в monster_templates, пишется в сохранение
+    std::string_view name;
     int hp;
     int attack;
     int defense;
+    int defense_divisor; // Во сколько раз ослабляется защита цели при атаке
+};
 
-public:
-    Monster(const std::string &name, int hp, int attack, int defense);
-    virtual ~Monster() = default;
-    virtual void attackTarget(Character& target) = 0;
-    virtual void displayInfo() const;
+enum MonsterTypeId : uint8_t
+{
+    GoblinId,
+    DragonId,
+    SkeletonId,
+    MonsterTypeCount
+};
 
-    int getDefense() const {return defense; }
-    int getHp() const { return hp; }
-    std::string getName() const { return name; }
-    
-    void setHp(int new_hp) {hp = new_hp; };
-    virtual void save(std::ofstream &out) const;
-    virtual void load(std::ifstream &in);
+// Таблица архетипов задаётся при компиляции: создание монстра по типу — копия строки таблицы
+inline constexpr MonsterTemplate monster_templates[MonsterTypeCount] = {
+    {GoblinId, "Goblin", 50, 8, 3, 10},
+    {DragonId, "Dragon", 200, 20, 15, 15},
+    {SkeletonId, "Skeleton", 80, 12, 8, 12},
+};
+
+inline constexpr const MonsterTemplate &goblin_template = monster_templates[GoblinId];
+inline constexpr const MonsterTemplate &dragon_template = monster_templates[DragonId];
+inline constexpr const MonsterTemplate &skeleton_template = monster_templates[SkeletonId];
+
+constexpr const MonsterTemplate *findMonsterTemplate(std::string_view name)
+{
+    for (const MonsterTemplate &type : monster_templates)
+    {
+        if (type.name == name)
+        {
+            return &type;
+        }
+    }
+    return nullptr;
+}
+
+// Формулы урона, общие для attackTarget и таблиц ниже
+constexpr int heroDamage(int attack, const MonsterTemplate &target)
+{
+    return std::max(1, attack - target.defense);
+}
+
+constexpr int monsterDamage(const MonsterTemplate &attacker, int defense)
+{
+    return std::max(1, attacker.attack - defense / attacker.defense_divisor);
+}
+
+constexpr int hitsToKill(int hp, int damage)
+{
+    return (hp + damage - 1) / damage;
+}
+
+// Бой героя уровня level (без экипировки) с монстром каждого типа, посчитанный при компиляции
+struct Matchup
+{
+    int hero_damage;
+    int monster_damage;
+    int hero_hits_to_kill;    // Ударов героя до победы над монстром
+    int monster_hits_to_kill; // Ударов монстра до гибели героя
 };
 
-class Goblin : public Monster
+inline constexpr int matchup_levels = 10;
+
+constexpr std::array<std::array<Matchup, MonsterTypeCount>, matchup_levels> makeMatchupTable()
+{
+    std::array<std::array<Matchup, MonsterTypeCount>, matchup_levels> table{};
+    for (int level = 1; level <= matchup_levels; ++level)
+    {
+        int hp = hero_archetype.hp + (level - 1) * hero_archetype.hp_per_level;
+        int attack = hero_archetype.attack + (level - 1) * hero_archetype.attack_per_level;
+        int defense = hero_archetype.defense + (level - 1) * hero_archetype.defense_per_level;
+        for (const MonsterTemplate &type : monster_templates)
+        {
+            Matchup &cell = table[level - 1][type.type_id];
+            cell.hero_damage = heroDamage(attack, type);
+            cell.monster_damage = monsterDamage(type, defense);
+            cell.hero_hits_to_kill = hitsToKill(type.hp, cell.hero_damage);
+            cell.monster_hits_to_kill = hitsToKill(hp, cell.monster_damage);
+        }
+    }
+    return table;
+}
+
+inline constexpr auto matchup_table = makeMatchupTable();
+
+constexpr bool heroWins(const Matchup &matchup)
+{
+    // Герой бьёт первым, поэтому при равенстве ударов побеждает он
+    return matchup.hero_hits_to_kill <= matchup.monster_hits_to_kill;
+}
+
+constexpr bool validMonsterTable()
+{
+    for (size_t i = 0; i < MonsterTypeCount; ++i)
+    {
+        const MonsterTemplate &type = monster_templates[i];
+        if (type.type_id != i || type.name.empty() || type.hp <= 0 || type.attack <= 0 ||
+            type.defense < 0 || type.defense_divisor <= 0)
+        {
+            return false;
+        }
+        for (size_t j = 0; j < i; ++j)
+        {
+            if (monster_templates[j].name == type.name)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static_assert(validMonsterTable(), "Monster archetypes must have unique names, matching ids and positive stats");
+static_assert(heroWins(matchup_table[0][GoblinId]), "A new hero must be able to beat a goblin");
+static_assert(!heroWins(matchup_table[0][DragonId]), "A dragon must be too strong for a new hero");
+static_assert(heroWins(matchup_table[matchup_levels - 1][DragonId]),
+              "A dragon must be beatable by a hero of the highest tabulated level");
+static_assert(dragon_template.hp > skeleton_template.hp && skeleton_template.hp > goblin_template.hp,
+              "Monster difficulty must grow from goblin to skeleton to dragon");
+
+// Кэш базового урона для пар (версия характеристик атакующего, версия характеристик цели).
+// Изменение характеристик выдаёт новую версию, старые записи просто перестают совпадать,
+// поэтому очищать кэш не нужно.
+class DamageCache
 {
 public:
-    Goblin();
-    void attackTarget(Character &target) override;
+    struct Entry
+    {
+        uint64_t key = 0;
+        int damage = 0;
+        int hits_to_kill = 0; // Ударов до гибели цели с полным здоровьем
+    };
+
+private:
+    static const size_t slot_count = 256;
+    Entry slots[slot_count];
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+    static std::atomic<uint64_t> &finishedHits();
+    static std::atomic<uint64_t> &finishedMisses();
+
+public:
+    DamageCache() = default;
+    ~DamageCache();
+    DamageCache(const DamageCache &) = delete;
+    DamageCache &operator=(const DamageCache &) = delete;
+
+    // У каждого потока свой кэш: сессии сервера не делят записи и не берут блокировку
+    static DamageCache &local();
+    // Версии начинаются после версий типов монстров, 0 не выдаётся никогда
+    static uint32_t nextVersion();
+    // Счётчики кэшей уже завершившихся потоков
+    static uint64_t totalHits() { return finishedHits(); }
+    static uint64_t totalMisses() { return finishedMisses(); }
+
+    template <typename Compute>
+    const Entry &lookup(uint32_t attacker_version, uint32_t defender_version, Compute compute)
+    {
+        uint64_t key = (static_cast<uint64_t>(attacker_version) << 32) | defender_version;
+        Entry &entry = slots[(attacker_version * 31u + defender_version) % slot_count];
+        if (entry.key == key)
+        {
+            ++hits;
+            return entry;
+        }
+        ++misses;
+        entry = compute();
+        entry.key = key;
+        return entry;
+    }
+
+    uint64_t getHits() const { return hits; }
+    uint64_t getMisses() const { return misses; }
 };
 
-class Dragon : public Monster
+// Экземпляр монстра хранит только изменяемое здоровье и идентификатор
+class Monster
 {
+protected:
+    const MonsterTemplate *type;
+    int hp;
+    int id;
+    EventLog *journal;
+
 public:
-    Dragon();
-    void attackTarget(Character &target) override;
+    Monster(const MonsterTemplate &type, int id = 0, EventLog *journal = nullptr);
+    void attackTarget(Character& target);
+    void displayInfo() const;
+
+    const MonsterTemplate &getType() const { return *type; }
+    void setJournal(EventLog *log) { journal = log; }
+    int getId() const { return id; }
+    int getDefense() const {return type->defense; }
+    int getHp() const { return hp; }
+    // Характеристики монстра неизменны, поэтому версия общая для всех монстров одного типа
+    uint32_t getStatVersion() const { return type->type_id + 1u; }
+    std::string_view getName() const { return type->name; }
+    
+    void setHp(int new_hp)
+    {
+        hp = new_hp;
+        if (journal)
+            journal->record(GameEvent::SetHp, id, hp);
+    };
+    void save(SaveWriter &out) const;
+    void load(SaveReader &in);
 };
 
-class Skeleton : public Monster
+// Пул монстров: слоты переиспользуются, спавн и сброс не выделяют память
+class MonsterPool
 {
+private:
+    std::vector<Monster> slots;
+    std::vector<size_t> live;     // Индексы занятых слотов (плотно)
+    std::vector<size_t> live_pos; // Позиция слота в live или npos
+    std::vector<size_t> free_slots;
+    size_t max_size;
+    int next_id;
+    EventLog *journal;
+
 public:
-    Skeleton();
-    void attackTarget(Character&target) override;
+    explicit MonsterPool(size_t capacity);
+    void setJournal(EventLog *log);
+    Monster &spawn(const MonsterTemplate &type);
+    Monster &spawn(const MonsterTemplate &type, int id);
+    void release(const Monster &monster);
+    Monster *find(int id);
+    void clear();
+    void save(SaveWriter &out) const;
+    void load(SaveReader &in);
+
+    size_t size() const { return live.size(); }
+    size_t capacity() const { return max_size; }
+    Monster &at(size_t index) { return slots[live.at(index)]; }
+    const Monster &at(size_t index) const { return slots[live.at(index)]; }
 };
 
+// Инвентарь из стопок: каждый тип предмета хранится один раз вместе с количеством.
+// Память и размер сохранения зависят от числа разных предметов, а не от числа добыч
 template <typename T>
 class Inventory
 {
 private:
-    std::vector<T> items;
+    struct Stack
+    {
+        const T *item; // Ключ из index: имя типа хранится в единственном экземпляре
+        uint32_t count;
+    };
+
+    struct Storage
+    {
+        std::vector<Stack> stacks;                // Плотно, без дыр
+        std::unordered_map<T, size_t> index;      // Тип предмета -> номер стопки
+
+        Storage() = default;
+        Storage(const Storage &other) : stacks(other.stacks.size()), index(other.index)
+        {
+            for (const auto &entry : index)
+            {
+                stacks[entry.second] = Stack{&entry.first, other.stacks[entry.second].count};
+            }
+        }
+        Storage &operator=(const Storage &) = delete;
+    };
+
+    // Копии инвентаря делят одно хранилище, пока одна из них не изменится (copy-on-write).
+    // Общее хранилище отмечается флагом при копировании: use_count() читается без синхронизации
+    // с потоками, которые отпускают снимки, и не годится для решения, можно ли менять буфер
+    std::shared_ptr<Storage> storage = std::make_shared<Storage>();
+    mutable bool shared = false;
+    EventLog *journal = nullptr;
+
+    Storage &mutableStorage()
+    {
+        if (shared)
+        {
+            storage = std::make_shared<Storage>(*storage);
+            shared = false;
+        }
+        return *storage;
+    }
+
+    static void addTo(Storage &target, const T &item, uint32_t count)
+    {
+        auto found = target.index.find(item);
+        if (found != target.index.end())
+        {
+            target.stacks[found->second].count += count;
+            return;
+        }
+        auto inserted = target.index.emplace(item, target.stacks.size()).first;
+        target.stacks.push_back(Stack{&inserted->first, count});
+    }
 
 public:
-    void addItem(const T &item)
+    Inventory() = default;
+    Inventory(const Inventory &other) : storage(other.storage), shared(true), journal(other.journal)
     {
-        items.push_back(item);
+        other.shared = true;
     }
-    void removeItem(size_t index)
+    Inventory(Inventory &&other) noexcept = default;
+    Inventory &operator=(const Inventory &other)
     {
-        if (index >= items.size())
+        if (this != &other)
         {
-            throw std::out_of_range("Invalid item index");
+            storage = other.storage;
+            shared = true;
+            other.shared = true;
+            journal = other.journal;
         }
-        items.erase(items.begin() + index);
+        return *this;
     }
+    Inventory &operator=(Inventory &&other) noexcept = default;
+
+    void setJournal(EventLog *log) { journal = log; }
+    void addItem(const T &item, uint32_t count = 1)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        addTo(mutableStorage(), item, count);
+        if (journal)
+            journal->record(GameEvent::AddItem, 0, static_cast<int32_t>(count), item);
+    }
+    void removeItem(const T &item, uint32_t count = 1)
+    {
+        auto found = storage->index.find(item);
+        if (found == storage->index.end() || storage->stacks[found->second].count < count)
+        {
+            throw std::out_of_range("Not enough items to remove");
+        }
+        Storage &own = mutableStorage();
+        size_t slot = own.index.find(item)->second;
+        own.stacks[slot].count -= count;
+        if (own.stacks[slot].count == 0)
+        {
+            // Последняя стопка занимает место опустевшей
+            own.stacks[slot] = own.stacks.back();
+            own.index[*own.stacks[slot].item] = slot;
+            own.stacks.pop_back();
+            own.index.erase(item);
+        }
+        if (journal)
+            journal->record(GameEvent::RemoveItem, 0, static_cast<int32_t>(count), item);
+    }
+    uint32_t count(const T &item) const
+    {
+        auto found = storage->index.find(item);
+        return found == storage->index.end() ? 0 : storage->stacks[found->second].count;
+    }
+    size_t distinctItems() const { return storage->stacks.size(); }
     void display() const {
-        for (size_t i = 0; i < items.size(); ++i) {
-            std::cout << i << ": " << items[i] << std::endl;
+        TextBuffer &out = TextBuffer::local();
+        for (size_t i = 0; i < storage->stacks.size(); ++i) {
+            const Stack &stack = storage->stacks[i];
+            out << i << ": " << *stack.item << " x" << stack.count << '\n';
         }
+        out.writeTo(gameOut());
     }
-    void save(std::ofstream &out) const
+    void save(SaveWriter &out) const
     {
-        out << items.size() << "\n";
-        for (const auto &item : items)
+        out.writeU32(static_cast<uint32_t>(storage->stacks.size()));
+        for (const Stack &stack : storage->stacks)
         {
-            out << item << "\n";
+            out.writeString(*stack.item);
+            out.writeU32(stack.count);
         }
     }
-    void load(std::ifstream& in)
+    // До версии 3 сохранение хранило каждый предмет отдельной строкой
+    void load(SaveReader &in, uint16_t version = save_version)
     {
-        size_t size;
-        in >> size;
-        items.clear();
-        std::string item;
-        std::getline(in, item);
-        for (size_t i = 0; i < size; ++i)
+        uint32_t size = in.readU32();
+        auto loaded = std::make_shared<Storage>();
+        loaded->stacks.reserve(size);
+        for (uint32_t i = 0; i < size; ++i)
         {
-            std::getline(in, item);
-            items.push_back(item);
+            T item = in.readString();
+            uint32_t item_count = version >= 3 ? in.readU32() : 1;
+            addTo(*loaded, item, item_count);
         }
+        storage = std::move(loaded);
     }
 };
 
+// Снимок состояния игры: контрольная точка сохранения и номер последнего учтённого события
+struct GameSnapshot
+{
+    Character player;
+    MonsterPool monsters;
+    Inventory<std::string> inventory;
+    uint64_t last_seq;
+
+    void save(const std::string &filename) const;
+    void load(const std::string &filename);
+    void apply(const GameEvent &event);
+};
+
+std::string journalFileName(const std::string &filename);
+
+// Автосохранение в фоновом потоке: новые события дописываются в журнал,
+// а контрольная точка целиком переписывает файл автосохранения и сокращает журнал.
+// Ручное сохранение пишется тем же потоком, но в свой файл, чтобы автосохранение его не затирало
+class Autosaver
+{
+private:
+    std::string filename;
+    std::chrono::milliseconds interval;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::condition_variable idle;
+    std::shared_ptr<const GameSnapshot> pending;
+    std::vector<GameEvent> pending_events;
+    std::shared_ptr<const GameSnapshot> pending_save; // Ручное сохранение в save_target
+    std::string save_target;
+    bool threaded;
+    bool writing;
+    bool save_now;
+    bool stopping;
+    // После неудачной записи журнал мог остаться с дырой или оборванной записью: события
+    // копятся в очереди и не дописываются, пока не будет записана полная контрольная точка
+    bool checkpoint_required;
+    size_t failed_writes;
+    std::string last_error;
+    std::thread worker;
+
+    void run();
+    void writeLocked(std::unique_lock<std::mutex> &lock);
+    bool hasWork() const;
+
+public:
+    // Без фонового потока (threaded = false) запись выполняет владелец через writePending()
+    Autosaver(const std::string &filename, std::chrono::milliseconds interval, bool threaded = true);
+    ~Autosaver();
+
+    Autosaver(const Autosaver &) = delete;
+    Autosaver &operator=(const Autosaver &) = delete;
+
+    void publishEvents(std::vector<GameEvent> events);
+    void publishCheckpoint(std::shared_ptr<const GameSnapshot> snapshot);
+    void publishSave(const std::string &target, std::shared_ptr<const GameSnapshot> snapshot);
+    void requestSave();
+    void flush();
+    void writePending();
+    std::string takeError();
+    bool checkpointRequired();
+};
+
+// Команда игры: то, что раньше выбиралось в меню Game::start()
+struct GameCommand
+{
+    enum Kind
+    {
+        Battle,
+        ShowStats,
+        Heal,
+        ShowInventory,
+        Save,
+        Load,
+        Exit,
+        NewGame
+    };
+
+    Kind kind;
+    std::string player_name; // Имя нового персонажа для NewGame
+};
+
+struct GameOptions
+{
+    std::string directory = "."; // Каталог сохранения и лога этой игры
+    std::chrono::milliseconds autosave_interval = std::chrono::seconds(30);
+    bool background_autosave = true; // false: автосохранение выполняет владелец через writeAutosave()
+    bool buffered_log = false;
+};
+
 class Game
 {
 private:
+    std::string save_file; // Ручное сохранение; автосохранение и журнал пишутся в autosave.dat
+    EventLog journal;
     Character player;
-    std::vector<std::unique_ptr<Monster>> monsters;
+    MonsterPool monsters;
     Inventory<std::string> inventory;
     Logger<std::string> logger;
+    Autosaver autosaver;
+    size_t events_since_checkpoint;
+    bool checkpoint_needed; // Сохранение ещё не соответствует этой игре
 
 public:
-    Game(const std::string& player_name);
+    Game(const std::string& player_name, const GameOptions& options = GameOptions());
     void start();
+    bool execute(const GameCommand& command);
     void battle();
+    bool isGameOver() const { return player.getHp() <= 0; }
+    void writeAutosave();
     void saveGame(const std::string& filename) const;
     void loadGame(const std::string& filename);
     void resetGame(const std::string& player_name);
+
+private:
+    void spawnStartingMonsters();
+    void attachJournal();
+    void publishChanges();
+    std::shared_ptr<const GameSnapshot> makeSnapshot() const;
 };
\ No newline at end of file
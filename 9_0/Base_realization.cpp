@@ -2,132 +2,690 @@
 #include <random>
 #include <ctime>
 
+// Переопределение события журнала
+void GameEvent::save(SaveWriter &out) const
+{
+    out.writeU64(seq);
+    out.writeU8(kind);
+    out.writeI32(target);
+    out.writeI32(value);
+    out.writeString(item);
+}
+
+void GameEvent::load(SaveReader &in)
+{
+    seq = in.readU64();
+    uint8_t raw_kind = in.readU8();
+    if (raw_kind > ReleaseMonster)
+    {
+        throw std::runtime_error("Unknown journal event: " + std::to_string(raw_kind));
+    }
+    kind = static_cast<Kind>(raw_kind);
+    target = in.readI32();
+    value = in.readI32();
+    item = in.readString();
+}
+
 // Переопределение персонажа
 Character::Character(const std::string &name, int hp, int attack, int defense)
-    : name(name), hp(hp), max_hp(hp), attack(attack), defense(defense), level(1), experience(0) {}
+    : name(name), hp(hp), max_hp(hp), attack(attack), defense(defense), level(1), experience(0),
+      stat_version(DamageCache::nextVersion()) {}
 void Character::attackTarget(Monster &target)
 {
-    int damage = std::max(1, attack - target.getDefense());
+    const MonsterTemplate &type = target.getType();
+    const DamageCache::Entry &entry = DamageCache::local().lookup(
+        stat_version, target.getStatVersion(), [&]
+        {
+            int damage = heroDamage(attack, type);
+            return DamageCache::Entry{0, damage, hitsToKill(type.hp, damage)};
+        });
+    int damage = entry.damage;
     target.setHp(std::max(0, target.getHp() - damage));
-    std::cout << name << " deals " << damage << " damage to " << target.getName() << std::endl;
+    TextBuffer &out = TextBuffer::local();
+    out << name << " deals " << damage << " damage to " << target.getName() << '\n';
+    out.writeTo(gameOut());
 }
 
 void Character::heal(int amount)
 {
-    hp = std::min(max_hp, hp + amount);
-    std::cout << name << " heals for " << amount << " HP" << std::endl;
+    setHp(std::min(max_hp, hp + amount));
+    TextBuffer &out = TextBuffer::local();
+    out << name << " heals for " << amount << " HP\n";
+    out.writeTo(gameOut());
 }
 
 void Character::gainExp(int exp)
 {
+    if (journal)
+        journal->record(GameEvent::GainExp, 0, exp);
+    int old_level = applyExp(exp);
+    TextBuffer &out = TextBuffer::local();
+    while (old_level < level)
+    {
+        out << name << " leveled up to " << ++old_level << "!\n";
+    }
+    out.writeTo(gameOut());
+}
+
+// Начисляет опыт без вывода и записи в журнал (используется и при восстановлении), возвращает прежний уровень
+int Character::applyExp(int exp)
+{
+    int old_level = level;
     experience += exp;
+    if (experience >= level * 100)
+    {
+        stat_version = DamageCache::nextVersion();
+    }
     while (experience >= level * 100)
     {
         experience -= level * 100;
         level++;
-        max_hp += 20;
+        max_hp += hero_archetype.hp_per_level;
         hp = max_hp;
-        attack += 5;
-        defense += 2;
-        std::cout << name << " leveled up to " << level << "!" << std::endl;
+        attack += hero_archetype.attack_per_level;
+        defense += hero_archetype.defense_per_level;
     }
+    return old_level;
 }
 
 void Character::displayInfo() const
 {
-    std::cout << "Name: " << name << "\nHP: " << hp << "/" << max_hp
-              << "\nLevel: " << level << "\nEXP: " << experience
-              << "\nAttack: " << attack << "\nDefense: " << defense << std::endl;
+    TextBuffer &out = TextBuffer::local();
+    out << "Name: " << name << "\nHP: " << hp << '/' << max_hp
+        << "\nLevel: " << level << "\nEXP: " << experience
+        << "\nAttack: " << attack << "\nDefense: " << defense << '\n';
+    out.writeTo(gameOut());
+}
+
+void Character::save(SaveWriter &out) const
+{
+    out.writeI32(hp);
+    out.writeI32(max_hp);
+    out.writeI32(attack);
+    out.writeI32(defense);
+    out.writeI32(level);
+    out.writeI32(experience);
+    out.writeString(name);
+}
+
+void Character::load(SaveReader &in)
+{
+    hp = in.readI32();
+    max_hp = in.readI32();
+    attack = in.readI32();
+    defense = in.readI32();
+    level = in.readI32();
+    experience = in.readI32();
+    name = in.readString();
+    stat_version = DamageCache::nextVersion();
 }
 
-void Character::save(std::ofstream &out) const
+DamageCache::~DamageCache()
 {
-    out << name << "\n"
-        << hp << " " << max_hp << " " << attack << " "
-        << defense << " " << level << " " << experience << "\n";
+    finishedHits() += hits;
+    finishedMisses() += misses;
 }
 
-void Character::load(std::ifstream &in)
+std::atomic<uint64_t> &DamageCache::finishedHits()
 {
-    std::getline(in, name);
-    in >> hp >> max_hp >> attack >> defense >> level >> experience;
+    static std::atomic<uint64_t> counter{0};
+    return counter;
+}
+
+std::atomic<uint64_t> &DamageCache::finishedMisses()
+{
+    static std::atomic<uint64_t> counter{0};
+    return counter;
+}
+
+DamageCache &DamageCache::local()
+{
+    thread_local DamageCache cache;
+    return cache;
+}
+
+uint32_t DamageCache::nextVersion()
+{
+    static std::atomic<uint32_t> counter{MonsterTypeCount + 1u};
+    return counter++;
 }
 
 // Переопределение монстров
-Monster::Monster(const std::string &name, int hp, int attack, int defense)
-    : name(name), hp(hp), attack(attack), defense(defense) {}
+Monster::Monster(const MonsterTemplate &type, int id, EventLog *journal)
+    : type(&type), hp(type.hp), id(id), journal(journal) {}
+
+void Monster::attackTarget(Character &target)
+{
+    const DamageCache::Entry &entry = DamageCache::local().lookup(
+        getStatVersion(), target.getStatVersion(), [&]
+        {
+            int damage = monsterDamage(*type, target.getDefense());
+            return DamageCache::Entry{0, damage, hitsToKill(target.getMaxHp(), damage)};
+        });
+    int damage = entry.damage;
+    target.setHp(std::max(0, target.getHp() - damage));
+    TextBuffer &out = TextBuffer::local();
+    out << type->name << " deals " << damage << " damage to " << target.getName() << '\n';
+    out.writeTo(gameOut());
+}
 
 void Monster::displayInfo() const
 {
-    std::cout << "Monster: " << name << "\nHP: " << hp
-              << "\nAttack: " << attack << "\nDefense: " << defense << std::endl;
+    TextBuffer &out = TextBuffer::local();
+    out << "Monster: " << type->name << "\nHP: " << hp
+        << "\nAttack: " << type->attack << "\nDefense: " << type->defense << '\n';
+    out.writeTo(gameOut());
 }
 
-void Monster::save(std::ofstream &out) const
+void Monster::save(SaveWriter &out) const
 {
-    out << name << "\n"
-        << hp << " " << attack << " " << defense << "\n";
+    out.writeU8(type->type_id);
+    out.writeI32(id);
+    out.writeI32(hp);
 }
 
-void Monster::load(std::ifstream &in)
+void Monster::load(SaveReader &in)
 {
-    std::getline(in, name);
-    in >> hp >> attack >> defense;
+    uint8_t type_id = in.readU8();
+    if (type_id >= MonsterTypeCount)
+    {
+        throw std::runtime_error("Unknown monster type id: " + std::to_string(type_id));
+    }
+    type = &monster_templates[type_id];
+    id = in.readI32();
+    hp = in.readI32();
 }
 
-// Переопределение гоблина
-Goblin::Goblin() : Monster("Goblin", 50, 8, 3) {}
+// Переопределение пула монстров
+MonsterPool::MonsterPool(size_t capacity) : max_size(capacity), next_id(1), journal(nullptr)
+{
+    slots.reserve(capacity);
+    live.reserve(capacity);
+    live_pos.reserve(capacity);
+    free_slots.reserve(capacity);
+}
 
-void Goblin::attackTarget(Character &target)
+void MonsterPool::setJournal(EventLog *log)
 {
-    int damage = std::max(1, attack - target.getDefense() / 10);
-    target.setHp(std::max(0, target.getHp() - damage));
-    std::cout << name << " deals " << damage << " damage to " << target.getName() << std::endl;
+    journal = log;
+    for (Monster &monster : slots)
+    {
+        monster.setJournal(log);
+    }
 }
 
-// Переопределение дракона
-Dragon::Dragon() : Monster("Dragon", 200, 20, 15) {}
+Monster &MonsterPool::spawn(const MonsterTemplate &type)
+{
+    return spawn(type, next_id);
+}
 
-void Dragon::attackTarget(Character &target)
+Monster &MonsterPool::spawn(const MonsterTemplate &type, int id)
 {
-    int damage = std::max(1, attack - target.getDefense() / 15);
-    target.setHp(std::max(0, target.getHp() - damage));
-    std::cout << name << " deals " << damage << " damage to " << target.getName() << std::endl;
+    size_t slot;
+    if (!free_slots.empty())
+    {
+        slot = free_slots.back();
+        free_slots.pop_back();
+        slots[slot] = Monster(type, id, journal);
+    }
+    else if (slots.size() < max_size)
+    {
+        slot = slots.size();
+        slots.emplace_back(type, id, journal);
+        live_pos.push_back(std::string::npos);
+    }
+    else
+    {
+        throw std::length_error("Monster pool is full");
+    }
+    next_id = std::max(next_id, id + 1);
+    live_pos[slot] = live.size();
+    live.push_back(slot);
+    if (journal)
+        journal->record(GameEvent::SpawnMonster, id, type.type_id);
+    return slots[slot];
 }
 
-// Переопределение скелета
-Skeleton::Skeleton() : Monster("Skeleton", 80, 12, 8) {}
+Monster *MonsterPool::find(int id)
+{
+    for (size_t slot : live)
+    {
+        if (slots[slot].getId() == id)
+        {
+            return &slots[slot];
+        }
+    }
+    return nullptr;
+}
 
-void Skeleton::attackTarget(Character &target)
+void MonsterPool::release(const Monster &monster)
 {
-    int damage = std::max(1, attack - target.getDefense() / 12);
-    target.setHp(std::max(0, target.getHp() - damage));
-    std::cout << name << " deals " << damage << " damage to " << target.getName() << std::endl;
+    size_t slot = static_cast<size_t>(&monster - slots.data());
+    if (slot >= slots.size() || live_pos[slot] == std::string::npos)
+    {
+        throw std::invalid_argument("Monster does not belong to the pool");
+    }
+    // Переносим последний живой слот на место освобождаемого
+    size_t pos = live_pos[slot];
+    live[pos] = live.back();
+    live_pos[live[pos]] = pos;
+    live.pop_back();
+    live_pos[slot] = std::string::npos;
+    free_slots.push_back(slot);
+    if (journal)
+        journal->record(GameEvent::ReleaseMonster, monster.getId(), 0);
+}
+
+void MonsterPool::clear()
+{
+    live.clear();
+    free_slots.clear();
+    for (size_t slot = slots.size(); slot > 0; --slot)
+    {
+        live_pos[slot - 1] = std::string::npos;
+        free_slots.push_back(slot - 1);
+    }
+    next_id = 1;
+}
+
+void MonsterPool::save(SaveWriter &out) const
+{
+    out.writeU32(static_cast<uint32_t>(live.size()));
+    for (size_t slot : live)
+    {
+        slots[slot].save(out);
+    }
+}
+
+void MonsterPool::load(SaveReader &in)
+{
+    uint32_t count = in.readU32();
+    if (count > max_size)
+    {
+        throw std::runtime_error("Too many monsters in save file");
+    }
+    clear();
+    EventLog *log = journal;
+    journal = nullptr; // Загрузка восстанавливает состояние, а не меняет его
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        Monster &monster = spawn(goblin_template);
+        monster.load(in);
+        next_id = std::max(next_id, monster.getId() + 1);
+    }
+    journal = log;
+}
+
+// Переопределение снимка и автосохранения
+std::string journalFileName(const std::string &filename)
+{
+    return filename + ".journal";
+}
+
+void GameSnapshot::save(const std::string &filename) const
+{
+    SaveWriter out;
+    out.writeU64(last_seq);
+    player.save(out);
+    monsters.save(out);
+    inventory.save(out);
+    writeSaveFile(filename, out);
+}
+
+void GameSnapshot::load(const std::string &filename)
+{
+    {
+        MappedFile file(filename, "load");
+        uint16_t version;
+        SaveReader in = openSaveData(file, version);
+        last_seq = version >= 2 ? in.readU64() : 0;
+        player.load(in);
+        monsters.load(in);
+        inventory.load(in, version);
+        if (!in.atEnd())
+        {
+            throw std::runtime_error("Unexpected data at end of save file");
+        }
+    }
+
+    // Доигрываем события, записанные после контрольной точки
+    const std::string journal_name = journalFileName(filename);
+    if (!std::filesystem::exists(journal_name))
+    {
+        return;
+    }
+    MappedFile file(journal_name, "load");
+    SaveReader journal(file.data(), file.size());
+    SaveReader record(nullptr, 0);
+    GameEvent event;
+    while (readJournalRecord(journal, record))
+    {
+        event.load(record);
+        if (event.seq > last_seq)
+        {
+            apply(event);
+            last_seq = event.seq;
+        }
+    }
+}
+
+void GameSnapshot::apply(const GameEvent &event)
+{
+    Monster *monster = nullptr;
+    if ((event.kind == GameEvent::SetHp && event.target != 0) || event.kind == GameEvent::ReleaseMonster)
+    {
+        monster = monsters.find(event.target);
+        if (!monster)
+        {
+            throw std::runtime_error("Journal refers to unknown monster " + std::to_string(event.target));
+        }
+    }
+    switch (event.kind)
+    {
+    case GameEvent::SetHp:
+        if (monster)
+            monster->setHp(event.value);
+        else
+            player.setHp(event.value);
+        break;
+    case GameEvent::GainExp:
+        player.applyExp(event.value);
+        break;
+    case GameEvent::AddItem:
+        // В журналах до стопок количество не записывалось (0) и означало один предмет
+        inventory.addItem(event.item, static_cast<uint32_t>(std::max(1, event.value)));
+        break;
+    case GameEvent::RemoveItem:
+        inventory.removeItem(event.item, static_cast<uint32_t>(event.value));
+        break;
+    case GameEvent::SpawnMonster:
+        if (event.value < 0 || event.value >= MonsterTypeCount)
+        {
+            throw std::runtime_error("Unknown monster type id: " + std::to_string(event.value));
+        }
+        monsters.spawn(monster_templates[event.value], event.target);
+        break;
+    case GameEvent::ReleaseMonster:
+        monsters.release(*monster);
+        break;
+    }
+}
+
+Autosaver::Autosaver(const std::string &filename, std::chrono::milliseconds interval, bool threaded)
+    : filename(filename), interval(interval), threaded(threaded), writing(false), save_now(false), stopping(false),
+      checkpoint_required(false), failed_writes(0)
+{
+    if (threaded)
+    {
+        worker = std::thread(&Autosaver::run, this);
+    }
+}
+
+Autosaver::~Autosaver()
+{
+    if (!threaded)
+    {
+        try
+        {
+            writePending();
+        }
+        catch (const std::exception &)
+        {
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeup.notify_one();
+    worker.join();
+}
+
+void Autosaver::publishEvents(std::vector<GameEvent> events)
+{
+    if (events.empty())
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pending_events.empty())
+    {
+        pending_events = std::move(events);
+    }
+    else
+    {
+        pending_events.insert(pending_events.end(), std::make_move_iterator(events.begin()),
+                              std::make_move_iterator(events.end()));
+    }
+}
+
+void Autosaver::publishCheckpoint(std::shared_ptr<const GameSnapshot> snapshot)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    pending = std::move(snapshot); // Более старая незаписанная точка больше не нужна
+    pending_events.clear();        // Как и опубликованные до неё события: точка их уже содержит
+}
+
+void Autosaver::publishSave(const std::string &target, std::shared_ptr<const GameSnapshot> snapshot)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        save_target = target;
+        pending_save = std::move(snapshot);
+        save_now = true;
+    }
+    wakeup.notify_one();
+}
+
+void Autosaver::requestSave()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        save_now = true;
+    }
+    wakeup.notify_one();
+}
+
+void Autosaver::flush()
+{
+    if (!threaded)
+    {
+        writePending();
+        return;
+    }
+    size_t failures;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        failures = failed_writes;
+    }
+    requestSave();
+    // Неудачная запись тоже завершает ожидание: ошибку вызывающий получит через takeError()
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this, failures] { return !writing && (!hasWork() || failed_writes != failures); });
+}
+
+void Autosaver::writePending()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    // Дожидаемся записи, начатой другим потоком, чтобы файлы менялись по порядку
+    idle.wait(lock, [this] { return !writing; });
+    writeLocked(lock);
+    idle.notify_all();
+}
+
+bool Autosaver::checkpointRequired()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return checkpoint_required;
+}
+
+// Есть ли что записать; события без контрольной точки ждут её, если журнал нельзя продолжать
+bool Autosaver::hasWork() const
+{
+    return pending || pending_save || (!pending_events.empty() && !checkpoint_required);
+}
+
+std::string Autosaver::takeError()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string error;
+    error.swap(last_error);
+    return error;
+}
+
+void Autosaver::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        wakeup.wait_for(lock, interval, [this] { return save_now || stopping; });
+        save_now = false;
+        size_t failures = failed_writes;
+        writeLocked(lock);
+        idle.notify_all();
+        // При остановке повторять неудачную запись бесполезно: ошибка уже сохранена в last_error
+        if (stopping && (!hasWork() || failed_writes != failures))
+        {
+            return;
+        }
+    }
+}
+
+// Пишет накопленные точку и события; блокировка снимается на время работы с диском
+void Autosaver::writeLocked(std::unique_lock<std::mutex> &lock)
+{
+    std::shared_ptr<const GameSnapshot> snapshot = std::move(pending);
+    pending.reset();
+    std::vector<GameEvent> events;
+    if (snapshot || !checkpoint_required)
+    {
+        events.swap(pending_events);
+    }
+    std::shared_ptr<const GameSnapshot> manual = std::move(pending_save);
+    pending_save.reset();
+    std::string target = save_target;
+    if (!snapshot && events.empty() && !manual)
+    {
+        return;
+    }
+    bool autosave_batch = snapshot || !events.empty();
+    writing = true;
+    lock.unlock();
+    std::string error;
+    try
+    {
+        if (manual)
+        {
+            // Ручное сохранение — полная точка без журнала; журнал от старых версий уже не относится к ней
+            manual->save(target);
+            std::filesystem::remove(journalFileName(target));
+        }
+        uint64_t covered_seq = 0;
+        if (snapshot)
+        {
+            snapshot->save(filename);
+            covered_seq = snapshot->last_seq;
+        }
+        SaveWriter journal;
+        SaveWriter record;
+        for (const GameEvent &event : events)
+        {
+            if (event.seq > covered_seq)
+            {
+                record.clear();
+                event.save(record);
+                appendJournalRecord(journal, record);
+            }
+        }
+        // После контрольной точки журнал начинается заново
+        if (snapshot || !journal.data().empty())
+        {
+            writeJournalFile(journalFileName(filename), journal, snapshot != nullptr);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        error = e.what();
+    }
+    lock.lock();
+    writing = false;
+    if (error.empty())
+    {
+        if (snapshot)
+        {
+            checkpoint_required = false;
+        }
+        return;
+    }
+    // Возвращаем пачку в очередь, если её не заменили более новые данные, и требуем контрольную точку
+    last_error = error;
+    ++failed_writes;
+    checkpoint_required = checkpoint_required || autosave_batch;
+    if (!pending)
+    {
+        pending = std::move(snapshot);
+        events.insert(events.end(), std::make_move_iterator(pending_events.begin()),
+                      std::make_move_iterator(pending_events.end()));
+        pending_events = std::move(events);
+    }
+    if (manual && !pending_save)
+    {
+        pending_save = std::move(manual);
+        save_target = target;
+    }
 }
 
 // Переопределение игры
-Game::Game(const std::string &player_name) : player(player_name), logger("game_log.txt")
+// Каталог создаётся до инициализации логгера и автосохранения
+static std::string prepareGameFile(const std::string &directory, const std::string &name)
 {
-    monsters.push_back(std::make_unique<Goblin>());
-    monsters.push_back(std::make_unique<Dragon>());
-    monsters.push_back(std::make_unique<Skeleton>());
+    std::filesystem::create_directories(directory);
+    return (std::filesystem::path(directory) / name).string();
+}
+
+Game::Game(const std::string &player_name, const GameOptions &options)
+    : save_file(prepareGameFile(options.directory, "save.dat")), player(player_name), monsters(16),
+      logger(prepareGameFile(options.directory, "game_log.txt"), options.buffered_log),
+      autosaver(prepareGameFile(options.directory, "autosave.dat"), options.autosave_interval,
+                options.background_autosave),
+      events_since_checkpoint(0), checkpoint_needed(true)
+{
+    // Стартовые монстры — часть начального состояния, а не события: журнал подключается после них,
+    // поэтому контрольная точка пишется только после первого настоящего изменения
+    spawnStartingMonsters();
+    attachJournal();
     logger.log("Game started by: " + player_name);
 }
 
+void Game::spawnStartingMonsters()
+{
+    monsters.spawn(goblin_template);
+    monsters.spawn(dragon_template);
+    monsters.spawn(skeleton_template);
+}
+
 void Game::resetGame(const std::string &player_name)
 {
     player = Character(player_name);
     monsters.clear();
-    monsters.push_back(std::make_unique<Goblin>());
-    monsters.push_back(std::make_unique<Dragon>());
-    monsters.push_back(std::make_unique<Skeleton>());
     inventory = Inventory<std::string>();
+    attachJournal();
+    spawnStartingMonsters();
+    // Новая игра не продолжает журнал старой: сразу пишем контрольную точку
+    journal.takeEvents();
+    autosaver.publishCheckpoint(makeSnapshot());
+    events_since_checkpoint = 0;
+    checkpoint_needed = false;
     logger.log("New game started for player: " + player_name);
 }
 
 void Game::start()
 {
     std::cout << "Welcome to the RPG Game!" << std::endl;
+    const GameCommand::Kind menu[] = {GameCommand::Battle, GameCommand::ShowStats, GameCommand::Heal,
+                                      GameCommand::ShowInventory, GameCommand::Save, GameCommand::Load,
+                                      GameCommand::Exit};
     bool game_running = true;
     while (game_running)
     {
@@ -136,58 +694,31 @@ void Game::start()
         std::cin >> choice;
         try
         {
-            switch (choice)
+            if (choice < 1 || choice > 7)
+            {
+                throw std::invalid_argument("Invalid choice");
+            }
+            game_running = execute(GameCommand{menu[choice - 1], std::string()});
+            if (game_running && menu[choice - 1] == GameCommand::Battle && isGameOver())
             {
-            case 1:
-                logger.log("Go battle");
-                battle();
-                if (player.getHp() <= 0)
+                std::cout << "Would you like to start a new game? (1: Yes, 2: No)\n";
+                int new_game_choice;
+                std::cin >> new_game_choice;
+                if (new_game_choice == 1)
                 {
-                    std::cout << "Would you like to start a new game? (1: Yes, 2: No)\n";
-                    int new_game_choice;
-                    std::cin >> new_game_choice;
-                    if (new_game_choice == 1)
-                    {
-                        std::cout << "Enter new player name: ";
-                        std::string new_name;
-                        std::cin.ignore();
-                        std::getline(std::cin, new_name);
-                        resetGame(new_name);
-                        logger.log("Player chose to start a new game");
-                        std::cout << "New game started!\n";
-                    }
-                    else
-                    {
-                        logger.log("Player chose to exit after game over");
-                        game_running = false;
-                    }
+                    std::cout << "Enter new player name: ";
+                    std::string new_name;
+                    std::cin.ignore();
+                    std::getline(std::cin, new_name);
+                    execute(GameCommand{GameCommand::NewGame, new_name});
+                    logger.log("Player chose to start a new game");
+                    std::cout << "New game started!\n";
+                }
+                else
+                {
+                    logger.log("Player chose to exit after game over");
+                    game_running = false;
                 }
-                break;
-            case 2:
-                player.displayInfo();
-                logger.log("View stats");
-                break;
-            case 3:
-                player.heal(20);
-                logger.log("Heal with 20 Hp");
-                break;
-            case 4:
-                inventory.display();
-                logger.log("View inventory");
-                break;
-            case 5:
-                saveGame("save.txt");
-                logger.log("Game saved");
-                break;
-            case 6:
-                loadGame("save.txt");
-                logger.log("Game loaded");
-                break;
-            case 7:
-                logger.log("Game exited");
-                return;
-            default:
-                throw std::invalid_argument("Invalid choice");
             }
         }
         catch (const std::exception &e)
@@ -195,62 +726,183 @@ void Game::start()
             std::cerr << "Error: " << e.what() << std::endl;
             logger.log("Error: " + std::string(e.what()));
         }
+        std::string autosave_error = autosaver.takeError();
+        if (!autosave_error.empty())
+        {
+            std::cerr << "Autosave error: " << autosave_error << std::endl;
+            logger.log("Autosave error: " + autosave_error);
+        }
+    }
+}
+
+// Выполняет одну команду; возвращает false, когда игра завершена
+bool Game::execute(const GameCommand &command)
+{
+    bool keep_running = true;
+    try
+    {
+        switch (command.kind)
+        {
+        case GameCommand::Battle:
+            logger.log("Go battle");
+            battle();
+            break;
+        case GameCommand::ShowStats:
+        {
+            player.displayInfo();
+            const DamageCache &cache = DamageCache::local();
+            gameOut() << "Damage cache: " << cache.getHits() << " hits, " << cache.getMisses() << " misses"
+                      << std::endl;
+            logger.log("View stats");
+            break;
+        }
+        case GameCommand::Heal:
+            player.heal(20);
+            logger.log("Heal with 20 Hp");
+            break;
+        case GameCommand::ShowInventory:
+            inventory.display();
+            logger.log("View inventory");
+            break;
+        case GameCommand::Save:
+            // Запись выполняет поток автосохранения, игровой цикл не ждёт диск
+            publishChanges();
+            autosaver.publishSave(save_file, makeSnapshot());
+            logger.log("Game save requested");
+            break;
+        case GameCommand::Load:
+            // Дожидаемся запрошенного ручного сохранения; автосохранение в save.dat не попадает
+            autosaver.flush();
+            loadGame(save_file);
+            logger.log("Game loaded");
+            break;
+        case GameCommand::Exit:
+            logger.log("Game exited");
+            keep_running = false;
+            break;
+        case GameCommand::NewGame:
+            if (command.player_name.empty())
+            {
+                throw std::invalid_argument("Player name cannot be empty");
+            }
+            resetGame(command.player_name);
+            break;
+        }
     }
+    catch (const std::exception &)
+    {
+        publishChanges();
+        throw;
+    }
+    publishChanges();
+    return keep_running;
+}
+
+void Game::writeAutosave()
+{
+    autosaver.writePending();
 }
 
 void Game::battle()
 {
     std::random_device rd;
     std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, monsters.size() - 1);
+    if (monsters.size() == 0)
+    {
+        throw std::runtime_error("No monsters to fight");
+    }
+    std::uniform_int_distribution<size_t> dis(0, monsters.size() - 1);
 
-    auto &monster = *monsters[dis(gen)]; // Выбираем случайного монстра
-    std::cout << "A wild " << monster.getName() << " appears!" << std::endl;
-    logger.log("Battle started with " + monster.getName());
+    auto &monster = monsters.at(dis(gen)); // Выбираем случайного монстра
+    // Сообщения боя пишутся без сброса потока; поток сбрасывается один раз в конце боя
+    TextBuffer &out = TextBuffer::local();
+    out << "A wild " << monster.getName() << " appears!\n";
+    out.writeTo(gameOut());
+    const std::string monster_name(monster.getName());
+    logger.log("Battle started with " + monster_name);
 
     while (player.getHp() > 0 && monster.getHp() > 0)
     {
         player.attackTarget(monster);
-        logger.log(player.getName() + " attacked " + monster.getName());
+        logger.log(player.getName() + " attacked " + monster_name);
         if (monster.getHp() <= 0)
         {
-            std::cout << monster.getName() << " defeated!" << std::endl;
+            out << monster.getName() << " defeated!\n";
+            out.writeTo(gameOut());
             player.gainExp(50);
             inventory.addItem("Monster Loot");
-            logger.log(monster.getName() + " defeated, gained 50 EXP");
+            logger.log(monster_name + " defeated, gained 50 EXP");
+            // Слот побеждённого монстра сразу занимает новый монстр того же типа
+            const MonsterTemplate &type = monster.getType();
+            monsters.release(monster);
+            monsters.spawn(type);
             break;
         }
         monster.attackTarget(player);
-        logger.log(monster.getName() + " attacked " + player.getName());
+        logger.log(monster_name + " attacked " + player.getName());
         if (player.getHp() <= 0)
         {
-            std::cout << "Game Over!" << std::endl;
+            gameOut() << "Game Over!\n";
             logger.log("Game Over: player died.");
-            return;
+            break;
         }
     }
+    gameOut().flush();
 }
 
-void Game::saveGame(const std::string &filename) const
+void Game::attachJournal()
 {
-    std::ofstream out(filename);
-    if (!out)
+    player.setJournal(&journal);
+    monsters.setJournal(&journal);
+    inventory.setJournal(&journal);
+}
+
+// Передаёт новые события на запись. Первое изменение новой игры и разросшийся журнал
+// вместо событий дают полную контрольную точку
+void Game::publishChanges()
+{
+    std::vector<GameEvent> events = journal.takeEvents();
+    // После сбоя записи журнал продолжать нельзя, нужна полная точка
+    bool journal_broken = autosaver.checkpointRequired();
+    if (events.empty() && !journal_broken)
     {
-        throw std::runtime_error("Cannot open save file");
+        return;
     }
-    player.save(out);
-    inventory.save(out);
-    out.close();
+    events_since_checkpoint += events.size();
+    if (checkpoint_needed || journal_broken || events_since_checkpoint >= 256)
+    {
+        autosaver.publishCheckpoint(makeSnapshot());
+        events_since_checkpoint = 0;
+        checkpoint_needed = false;
+    }
+    else
+    {
+        autosaver.publishEvents(std::move(events));
+    }
+}
+
+std::shared_ptr<const GameSnapshot> Game::makeSnapshot() const
+{
+    // Копия инвентаря разделяет буфер с оригиналом, поэтому снимок дешёвый
+    return std::make_shared<const GameSnapshot>(GameSnapshot{player, monsters, inventory, journal.lastSeq()});
+}
+
+void Game::saveGame(const std::string &filename) const
+{
+    makeSnapshot()->save(filename);
 }
 
 void Game::loadGame(const std::string &filename)
 {
-    std::ifstream in(filename);
-    if (!in)
-    {
-        throw std::runtime_error("Cannot open load file");
-    }
-    player.load(in);
-    inventory.load(in);
-    in.close();
+    // Читаем во временный снимок, чтобы повреждённый файл не испортил текущую игру
+    GameSnapshot loaded{Character(player.getName()), MonsterPool(monsters.capacity()), Inventory<std::string>(), 0};
+    loaded.load(filename);
+    player = std::move(loaded.player);
+    monsters = std::move(loaded.monsters);
+    inventory = std::move(loaded.inventory);
+    journal.restart(loaded.last_seq);
+    attachJournal();
+    autosaver.publishCheckpoint(makeSnapshot());
+    events_since_checkpoint = 0;
+    checkpoint_needed = false;
 }
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "Base_realization.cpp"
+#include "Session_server.h"
+#include <algorithm>
+
+// Генератор нагрузки для SessionServer: каждая сессия шлёт следующую команду,
+// как только получила ответ на предыдущую.
+// Запуск: Load_generator [сессий] [потоков] [команд на сессию] [каталог]
+int main(int argc, char *argv[])
+{
+    try
+    {
+        size_t session_count = argc > 1 ? std::stoul(argv[1]) : 1000;
+        size_t threads = argc > 2 ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+        size_t commands_per_session = argc > 3 ? std::stoul(argv[3]) : 100;
+        std::string root = argc > 4 ? argv[4] : "load_sessions";
+
+        SessionServer server(root, threads);
+        for (size_t i = 0; i < session_count; ++i)
+        {
+            server.openSession("Player_" + std::to_string(i));
+        }
+
+        // Задержки каждой сессии пишет только её рабочий поток, поэтому блокировка не нужна
+        std::vector<std::vector<double>> latencies(session_count);
+        std::vector<std::mt19937> generators;
+        for (size_t i = 0; i < session_count; ++i)
+        {
+            latencies[i].reserve(commands_per_session);
+            generators.emplace_back(static_cast<unsigned>(i));
+        }
+        std::atomic<size_t> errors{0};
+        std::mutex done_mutex;
+        std::condition_variable all_done;
+        size_t finished_sessions = 0;
+
+        const GameCommand::Kind mix[] = {GameCommand::Battle, GameCommand::Battle, GameCommand::Heal,
+                                         GameCommand::ShowStats, GameCommand::ShowInventory, GameCommand::Save};
+        std::function<void(const CommandResult &)> on_result = [&](const CommandResult &result)
+        {
+            std::vector<double> &own = latencies[result.session];
+            own.push_back(std::chrono::duration<double, std::micro>(result.latency).count());
+            if (!result.ok)
+            {
+                ++errors;
+            }
+            if (own.size() == commands_per_session)
+            {
+                std::lock_guard<std::mutex> lock(done_mutex);
+                if (++finished_sessions == session_count)
+                {
+                    all_done.notify_one();
+                }
+                return;
+            }
+            GameCommand next{GameCommand::NewGame, std::string()};
+            if (result.game_over)
+            {
+                next.player_name = "Player_" + std::to_string(result.session);
+            }
+            else
+            {
+                std::uniform_int_distribution<size_t> pick(0, std::size(mix) - 1);
+                next.kind = mix[pick(generators[result.session])];
+            }
+            server.submit(result.session, next, on_result);
+        };
+
+        auto started = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < session_count; ++i)
+        {
+            server.submit(i, GameCommand{GameCommand::ShowStats, std::string()}, on_result);
+        }
+        {
+            std::unique_lock<std::mutex> lock(done_mutex);
+            all_done.wait(lock, [&] { return finished_sessions == session_count; });
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        // Кэши урона рабочих потоков отдают свои счётчики при завершении потоков
+        server.shutdown();
+
+        std::vector<double> all;
+        all.reserve(session_count * commands_per_session);
+        for (const auto &own : latencies)
+        {
+            all.insert(all.end(), own.begin(), own.end());
+        }
+        std::sort(all.begin(), all.end());
+        auto percentile = [&all](double p)
+        {
+            return all.empty() ? 0.0 : all[std::min(all.size() - 1, static_cast<size_t>(p * all.size()))];
+        };
+
+        std::cout << "Sessions: " << session_count << ", threads: " << threads
+                  << ", commands: " << all.size() << ", errors: " << errors << "\n"
+                  << "Throughput: " << all.size() / seconds << " commands/sec\n"
+                  << "Latency p50: " << percentile(0.50) << " us, p99: " << percentile(0.99)
+                  << " us, max: " << (all.empty() ? 0.0 : all.back()) << " us\n"
+                  << "Damage cache: " << DamageCache::totalHits() << " hits, " << DamageCache::totalMisses()
+                  << " misses" << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fatal error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,191 @@
+#include "Base_realization.cpp"
+#include <algorithm>
+
+// Прежний текстовый формат персонажа: имя строкой, затем характеристики через пробел
+class TextCharacter : public Character
+{
+public:
+    using Character::Character;
+
+    void saveText(std::ostream &out) const
+    {
+        out << name << "\n"
+            << hp << " " << max_hp << " " << attack << " "
+            << defense << " " << level << " " << experience << "\n";
+    }
+    void loadText(std::istream &in)
+    {
+        std::getline(in, name);
+        in >> hp >> max_hp >> attack >> defense >> level >> experience;
+    }
+};
+
+// Текстовое сохранение с теми же данными, что и двоичное: персонаж, монстры строками
+// "тип\nid hp" и предметы по одному на строку после их числа, как в прежних save/load
+void saveText(const std::string &filename, const TextCharacter &player, const MonsterPool &monsters,
+              const std::vector<std::string> &items)
+{
+    std::ofstream out(filename);
+    if (!out)
+    {
+        throw std::runtime_error("Cannot open save file");
+    }
+    player.saveText(out);
+    out << monsters.size() << "\n";
+    for (size_t i = 0; i < monsters.size(); ++i)
+    {
+        const Monster &monster = monsters.at(i);
+        out << monster.getName() << "\n"
+            << monster.getId() << " " << monster.getHp() << "\n";
+    }
+    out << items.size() << "\n";
+    for (const std::string &item : items)
+    {
+        out << item << "\n";
+    }
+    if (!out)
+    {
+        throw std::runtime_error("Failed to write save file");
+    }
+}
+
+void loadText(const std::string &filename, TextCharacter &player, MonsterPool &monsters,
+              Inventory<std::string> &inventory)
+{
+    std::ifstream in(filename);
+    if (!in)
+    {
+        throw std::runtime_error("Cannot open load file");
+    }
+    player.loadText(in);
+    size_t count = 0;
+    in >> count;
+    in.ignore();
+    monsters.clear();
+    std::string name;
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::getline(in, name);
+        const MonsterTemplate *type = findMonsterTemplate(name);
+        if (!type)
+        {
+            throw std::runtime_error("Unknown monster type: " + name);
+        }
+        int id = 0, hp = 0;
+        in >> id >> hp;
+        in.ignore();
+        monsters.spawn(*type, id).setHp(hp);
+    }
+    in >> count;
+    in.ignore();
+    std::string item;
+    for (size_t i = 0; i < count && std::getline(in, item); ++i)
+    {
+        inventory.addItem(item);
+    }
+    if (!in)
+    {
+        throw std::runtime_error("Failed to read save file");
+    }
+}
+
+// Сохранение и загрузка игры с item_count предметами kinds разных видов, лучшее из trials попыток
+void runScenario(const char *label, size_t item_count, size_t kinds, size_t monster_count)
+{
+    const int trials = 3;
+    const std::string binary_file = "save_bench.dat";
+    const std::string text_file = "save_bench.txt";
+
+    std::vector<std::string> items;
+    items.reserve(item_count);
+    for (size_t i = 0; i < item_count; ++i)
+    {
+        items.push_back("Item_" + std::to_string(i % kinds));
+    }
+    GameSnapshot game{Character("Hero"), MonsterPool(monster_count), Inventory<std::string>(), 0};
+    TextCharacter text_player("Hero");
+    for (const std::string &item : items)
+    {
+        game.inventory.addItem(item);
+    }
+    for (size_t i = 0; i < monster_count; ++i)
+    {
+        game.monsters.spawn(monster_templates[i % MonsterTypeCount]);
+    }
+
+    auto seconds = [](std::chrono::steady_clock::time_point started)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    };
+    double binary_save = 1e30, binary_load = 1e30, text_save = 1e30, text_load = 1e30;
+    for (int trial = 0; trial < trials; ++trial)
+    {
+        auto started = std::chrono::steady_clock::now();
+        game.save(binary_file);
+        binary_save = std::min(binary_save, seconds(started));
+
+        GameSnapshot loaded{Character("Hero"), MonsterPool(monster_count), Inventory<std::string>(), 0};
+        started = std::chrono::steady_clock::now();
+        loaded.load(binary_file);
+        binary_load = std::min(binary_load, seconds(started));
+        if (loaded.inventory.distinctItems() != game.inventory.distinctItems() ||
+            loaded.monsters.size() != monster_count)
+        {
+            throw std::runtime_error("Binary save lost records");
+        }
+
+        started = std::chrono::steady_clock::now();
+        saveText(text_file, text_player, game.monsters, items);
+        text_save = std::min(text_save, seconds(started));
+
+        TextCharacter text_loaded("Hero");
+        MonsterPool text_monsters(monster_count);
+        Inventory<std::string> text_inventory;
+        started = std::chrono::steady_clock::now();
+        loadText(text_file, text_loaded, text_monsters, text_inventory);
+        text_load = std::min(text_load, seconds(started));
+        if (text_inventory.distinctItems() != game.inventory.distinctItems() || text_monsters.size() != monster_count)
+        {
+            throw std::runtime_error("Text save lost records");
+        }
+    }
+
+    auto report = [](const char *format, double save, double load, uintmax_t bytes)
+    {
+        std::cout << "  " << format << ": save " << save * 1000 << " ms, load " << load * 1000 << " ms, "
+                  << bytes / 1024.0 / 1024.0 << " MB\n";
+    };
+    std::cout << label << ": " << item_count << " items of " << kinds << " kinds, " << monster_count
+              << " monsters, best of " << trials << " trials\n";
+    report("Binary", binary_save, binary_load, std::filesystem::file_size(binary_file));
+    report("Text", text_save, text_load, std::filesystem::file_size(text_file));
+    std::filesystem::remove(binary_file);
+    std::filesystem::remove(text_file);
+}
+
+// Замер сохранения и загрузки игры с большим инвентарём: двоичный формат с CRC32C
+// и атомарной заменой файла против прежнего текстового формата с теми же данными.
+// Все предметы разные — сравниваются сами форматы; добыча из немногих видов — двоичный
+// формат хранит стопку один раз, а текстовый пишет каждый предмет строкой.
+// Запуск: Save_benchmark [предметов] [монстров] [видов добычи]
+int main(int argc, char *argv[])
+{
+    try
+    {
+        size_t item_count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+        size_t monster_count = argc > 2 ? std::stoul(argv[2]) : 1000;
+        size_t loot_kinds = argc > 3 ? std::stoul(argv[3]) : 1000;
+        if (item_count == 0 || loot_kinds == 0)
+        {
+            throw std::invalid_argument("Item and loot kind counts must be positive");
+        }
+        runScenario("Distinct items", item_count, item_count, monster_count);
+        runScenario("Loot", item_count, std::min(loot_kinds, item_count), monster_count);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fatal error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,227 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <filesystem>
+#include "../common/Mapped_file.h"
+
+// Двоичный формат сохранения:
+// [магия "RPGS"][версия u16][резерв u16][размер данных u32][CRC32C данных u32][данные]
+// Все числа записываются в little-endian независимо от платформы.
+const char save_magic[4] = {'R', 'P', 'G', 'S'};
+// 2: номер последнего события журнала в начале данных; 3: инвентарь хранится стопками
+const uint16_t save_version = 3;
+const size_t save_header_size = 16;
+
+inline uint32_t crc32c(const char *data, size_t size, uint32_t crc = 0)
+{
+    static const struct Table
+    {
+        uint32_t values[256];
+        Table()
+        {
+            for (uint32_t i = 0; i < 256; ++i)
+            {
+                uint32_t value = i;
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    value = (value & 1) ? (value >> 1) ^ 0x82F63B78u : value >> 1;
+                }
+                values[i] = value;
+            }
+        }
+    } table;
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+    {
+        crc = table.values[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+class SaveWriter
+{
+private:
+    std::string buffer;
+
+public:
+    void writeU8(uint8_t value) { buffer.push_back(static_cast<char>(value)); }
+    void writeU16(uint16_t value)
+    {
+        writeU8(static_cast<uint8_t>(value));
+        writeU8(static_cast<uint8_t>(value >> 8));
+    }
+    void writeU32(uint32_t value)
+    {
+        writeU16(static_cast<uint16_t>(value));
+        writeU16(static_cast<uint16_t>(value >> 16));
+    }
+    void writeI32(int32_t value) { writeU32(static_cast<uint32_t>(value)); }
+    void writeU64(uint64_t value)
+    {
+        writeU32(static_cast<uint32_t>(value));
+        writeU32(static_cast<uint32_t>(value >> 32));
+    }
+    void writeBytes(const char *bytes, size_t count) { buffer.append(bytes, count); }
+    void writeString(const std::string &value)
+    {
+        writeU32(static_cast<uint32_t>(value.size()));
+        writeBytes(value.data(), value.size());
+    }
+
+    const std::string &data() const { return buffer; }
+    void clear() { buffer.clear(); }
+};
+
+class SaveReader
+{
+private:
+    const char *data;
+    size_t size;
+    size_t pos;
+
+    const char *take(size_t count)
+    {
+        if (size - pos < count)
+        {
+            throw std::runtime_error("Save file is truncated");
+        }
+        const char *result = data + pos;
+        pos += count;
+        return result;
+    }
+
+public:
+    SaveReader(const char *data, size_t size) : data(data), size(size), pos(0) {}
+
+    uint8_t readU8() { return static_cast<uint8_t>(*take(1)); }
+    uint16_t readU16()
+    {
+        uint16_t low = readU8();
+        return static_cast<uint16_t>(low | (readU8() << 8));
+    }
+    uint32_t readU32()
+    {
+        uint32_t low = readU16();
+        return low | (static_cast<uint32_t>(readU16()) << 16);
+    }
+    int32_t readI32() { return static_cast<int32_t>(readU32()); }
+    uint64_t readU64()
+    {
+        uint64_t low = readU32();
+        return low | (static_cast<uint64_t>(readU32()) << 32);
+    }
+    std::string readString()
+    {
+        uint32_t length = readU32();
+        const char *bytes = take(length);
+        return std::string(bytes, length);
+    }
+
+    bool atEnd() const { return pos == size; }
+    size_t remaining() const { return size - pos; }
+    const char *current() const { return data + pos; }
+    void skip(size_t count) { take(count); }
+};
+
+// Записывает заголовок и данные во временный файл и атомарно заменяет им старое сохранение
+inline void writeSaveFile(const std::string &filename, const SaveWriter &payload)
+{
+    const std::string &data = payload.data();
+    SaveWriter header;
+    for (char c : save_magic)
+    {
+        header.writeU8(static_cast<uint8_t>(c));
+    }
+    header.writeU16(save_version);
+    header.writeU16(0);
+    header.writeU32(static_cast<uint32_t>(data.size()));
+    header.writeU32(crc32c(data.data(), data.size()));
+
+    const std::string temp_name = filename + ".tmp";
+    {
+        std::ofstream out(temp_name, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            throw std::runtime_error("Cannot open save file");
+        }
+        out.write(header.data().data(), static_cast<std::streamsize>(header.data().size()));
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        out.flush();
+        if (!out)
+        {
+            throw std::runtime_error("Failed to write save file");
+        }
+    }
+    std::filesystem::rename(temp_name, filename);
+}
+
+// Проверяет заголовок и контрольную сумму, возвращает читателя данных
+inline SaveReader openSaveData(const MappedFile &file, uint16_t &version)
+{
+    if (file.size() < save_header_size || std::memcmp(file.data(), save_magic, sizeof(save_magic)) != 0)
+    {
+        throw std::runtime_error("Not a save file");
+    }
+    SaveReader header(file.data() + sizeof(save_magic), save_header_size - sizeof(save_magic));
+    version = header.readU16();
+    header.readU16();
+    uint32_t size = header.readU32();
+    uint32_t checksum = header.readU32();
+    if (version == 0 || version > save_version)
+    {
+        throw std::runtime_error("Unsupported save version: " + std::to_string(version));
+    }
+    const char *data = file.data() + save_header_size;
+    if (file.size() - save_header_size != size || crc32c(data, size) != checksum)
+    {
+        throw std::runtime_error("Save file is corrupted");
+    }
+    return SaveReader(data, size);
+}
+
+// Журнал событий: записи [длина u32][CRC32C u32][данные] дописываются в конец файла
+inline void appendJournalRecord(SaveWriter &journal, const SaveWriter &record)
+{
+    const std::string &data = record.data();
+    journal.writeU32(static_cast<uint32_t>(data.size()));
+    journal.writeU32(crc32c(data.data(), data.size()));
+    journal.writeBytes(data.data(), data.size());
+}
+
+inline void writeJournalFile(const std::string &filename, const SaveWriter &journal, bool truncate)
+{
+    std::ofstream out(filename, std::ios::binary | (truncate ? std::ios::trunc : std::ios::app));
+    if (!out)
+    {
+        throw std::runtime_error("Cannot open journal file");
+    }
+    out.write(journal.data().data(), static_cast<std::streamsize>(journal.data().size()));
+    out.flush();
+    if (!out)
+    {
+        throw std::runtime_error("Failed to write journal file");
+    }
+}
+
+// Читает следующую целую запись журнала; оборванная или повреждённая запись (сбой во время записи)
+// считается концом журнала
+inline bool readJournalRecord(SaveReader &journal, SaveReader &record)
+{
+    if (journal.remaining() < 8)
+    {
+        return false;
+    }
+    uint32_t size = journal.readU32();
+    uint32_t checksum = journal.readU32();
+    if (journal.remaining() < size || crc32c(journal.current(), size) != checksum)
+    {
+        return false;
+    }
+    record = SaveReader(journal.current(), size);
+    journal.skip(size);
+    return true;
+}
@@ -0,0 +1,236 @@
+#pragma once
+#include "Base_classes.h"
+#include <deque>
+#include <functional>
+#include <atomic>
+
+// Результат выполнения команды в сессии
+struct CommandResult
+{
+    size_t session;
+    bool ok;
+    bool running;   // false: сессия завершена командой Exit
+    bool game_over; // Персонаж погиб, ждём NewGame
+    std::string output;
+    std::string error;
+    std::chrono::steady_clock::duration latency;
+};
+
+// Сервер сессий: множество независимых игр в одном процессе.
+// Сессия закреплена за одним рабочим потоком, поэтому её команды выполняются по порядку
+// и саму игру не нужно защищать блокировкой.
+class SessionServer
+{
+public:
+    using Callback = std::function<void(const CommandResult &)>;
+
+private:
+    struct Session
+    {
+        std::unique_ptr<Game> game;
+        std::ostringstream output;
+        bool running = true;
+    };
+
+    struct Task
+    {
+        size_t session;
+        GameCommand command;
+        Callback done;
+        std::chrono::steady_clock::time_point submitted;
+    };
+
+    struct Worker
+    {
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<Task> queue;
+    };
+
+    std::string root;
+    std::chrono::milliseconds autosave_interval;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::deque<std::unique_ptr<Session>> sessions; // deque не перемещает уже созданные сессии
+    mutable std::mutex sessions_mutex;
+    std::thread autosave_thread;
+    std::mutex autosave_mutex;
+    std::condition_variable autosave_wakeup;
+    std::atomic<bool> stopping{false};
+
+    Session &session(size_t id)
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex);
+        if (id >= sessions.size())
+        {
+            throw std::out_of_range("Unknown session: " + std::to_string(id));
+        }
+        return *sessions[id];
+    }
+
+    void runWorker(Worker &worker)
+    {
+        while (true)
+        {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(worker.mutex);
+                worker.ready.wait(lock, [&] { return stopping || !worker.queue.empty(); });
+                if (worker.queue.empty())
+                {
+                    return;
+                }
+                task = std::move(worker.queue.front());
+                worker.queue.pop_front();
+            }
+            CommandResult result = runTask(task);
+            if (task.done)
+            {
+                task.done(result);
+            }
+        }
+    }
+
+    CommandResult runTask(const Task &task)
+    {
+        CommandResult result{task.session, false, false, false, std::string(), std::string(), {}};
+        Session &current = session(task.session);
+        if (!current.running)
+        {
+            result.error = "Session is closed";
+        }
+        else
+        {
+            // Вывод игры попадает в буфер сессии, а не в общую консоль
+            std::ostream *previous = gameOutput();
+            gameOutput() = &current.output;
+            try
+            {
+                current.running = current.game->execute(task.command);
+                result.ok = true;
+            }
+            catch (const std::exception &e)
+            {
+                result.error = e.what();
+            }
+            gameOutput() = previous;
+            result.output = current.output.str();
+            current.output.str("");
+            result.game_over = current.game->isGameOver();
+        }
+        result.running = current.running;
+        result.latency = std::chrono::steady_clock::now() - task.submitted;
+        return result;
+    }
+
+    // Один общий поток автосохранения вместо потока на каждую игру
+    void runAutosave()
+    {
+        std::unique_lock<std::mutex> lock(autosave_mutex);
+        while (!stopping)
+        {
+            autosave_wakeup.wait_for(lock, autosave_interval, [this] { return stopping.load(); });
+            lock.unlock();
+            size_t count = sessionCount();
+            for (size_t id = 0; id < count; ++id)
+            {
+                session(id).game->writeAutosave();
+            }
+            lock.lock();
+        }
+    }
+
+public:
+    SessionServer(const std::string &root, size_t threads,
+                  std::chrono::milliseconds autosave_interval = std::chrono::seconds(30))
+        : root(root), autosave_interval(autosave_interval)
+    {
+        if (threads == 0)
+        {
+            throw std::invalid_argument("Server needs at least one worker thread");
+        }
+        for (size_t i = 0; i < threads; ++i)
+        {
+            workers.push_back(std::make_unique<Worker>());
+        }
+        for (auto &worker : workers)
+        {
+            Worker *current = worker.get();
+            current->thread = std::thread([this, current] { runWorker(*current); });
+        }
+        autosave_thread = std::thread(&SessionServer::runAutosave, this);
+    }
+
+    ~SessionServer()
+    {
+        shutdown();
+    }
+
+    SessionServer(const SessionServer &) = delete;
+    SessionServer &operator=(const SessionServer &) = delete;
+
+    // Создаёт игру со своим каталогом сохранения и лога: <root>/session_<id>
+    size_t openSession(const std::string &player_name)
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex);
+        size_t id = sessions.size();
+        GameOptions options;
+        options.directory = (std::filesystem::path(root) / ("session_" + std::to_string(id))).string();
+        options.autosave_interval = autosave_interval;
+        options.background_autosave = false;
+        options.buffered_log = true;
+        auto created = std::make_unique<Session>();
+        created->game = std::make_unique<Game>(player_name, options);
+        sessions.push_back(std::move(created));
+        return id;
+    }
+
+    size_t sessionCount() const
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex);
+        return sessions.size();
+    }
+
+    // Ставит команду в очередь рабочего потока сессии; done вызывается в этом потоке
+    void submit(size_t session_id, const GameCommand &command, Callback done)
+    {
+        Worker &worker = *workers[session_id % workers.size()];
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            if (stopping)
+            {
+                throw std::runtime_error("Server is shutting down");
+            }
+            worker.queue.push_back(Task{session_id, command, std::move(done), std::chrono::steady_clock::now()});
+        }
+        worker.ready.notify_one();
+    }
+
+    // Выполняет уже поставленные команды, останавливает потоки и сохраняет все игры
+    void shutdown()
+    {
+        if (stopping.exchange(true))
+        {
+            return;
+        }
+        // Захват мьютекса перед уведомлением не даёт потоку пропустить пробуждение
+        for (auto &worker : workers)
+        {
+            {
+                std::lock_guard<std::mutex> lock(worker->mutex);
+            }
+            worker->ready.notify_one();
+        }
+        {
+            std::lock_guard<std::mutex> lock(autosave_mutex);
+        }
+        autosave_wakeup.notify_one();
+        for (auto &worker : workers)
+        {
+            worker->thread.join();
+        }
+        autosave_thread.join();
+        std::lock_guard<std::mutex> lock(sessions_mutex);
+        sessions.clear();
+    }
+};
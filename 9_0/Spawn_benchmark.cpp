@@ -0,0 +1,129 @@
+#include "Base_realization.cpp"
+#include <algorithm>
+
+// Прежнее представление монстра: отдельный объект в куче со своей копией имени и характеристик
+class HeapMonster
+{
+public:
+    std::string name;
+    int hp;
+    int attack;
+    int defense;
+    int id;
+
+    HeapMonster(const MonsterTemplate &type, int id)
+        : name(type.name), hp(type.hp), attack(type.attack), defense(type.defense), id(id) {}
+    virtual ~HeapMonster() = default;
+};
+
+// Замер спавна монстров: заполнение, замена случайных монстров новыми и сброс.
+// Пул с шаблонами сравнивается с прежним созданием каждого монстра через make_unique.
+// Запуск: Spawn_benchmark [монстров] [замен]
+int main(int argc, char *argv[])
+{
+    try
+    {
+        size_t monster_count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+        size_t replacements = argc > 2 ? std::stoul(argv[2]) : 5000000;
+        if (monster_count == 0)
+        {
+            throw std::invalid_argument("Monster count must be positive");
+        }
+        const int trials = 3;
+
+        std::mt19937 random(42);
+        std::vector<uint32_t> types(monster_count + replacements);
+        for (uint32_t &type : types)
+        {
+            type = random() % MonsterTypeCount;
+        }
+        std::vector<size_t> victims(replacements);
+        for (size_t &victim : victims)
+        {
+            victim = random() % monster_count;
+        }
+        auto seconds = [](std::chrono::steady_clock::time_point started)
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        };
+
+        struct Times
+        {
+            double fill = 1e30;
+            double churn = 1e30;
+            double reset = 1e30;
+        };
+        Times pool_best, heap_best;
+        size_t checksum = 0; // Не даёт компилятору выбросить созданных монстров
+
+        // Пул создаётся один раз, как в Game: сброс между попытками возвращает слоты в свободные
+        MonsterPool pool(monster_count);
+        for (int trial = 0; trial < trials; ++trial)
+        {
+            {
+                std::vector<Monster *> spawned(monster_count);
+                auto started = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < monster_count; ++i)
+                {
+                    spawned[i] = &pool.spawn(monster_templates[types[i]]);
+                }
+                pool_best.fill = std::min(pool_best.fill, seconds(started));
+
+                started = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < replacements; ++i)
+                {
+                    size_t victim = victims[i];
+                    pool.release(*spawned[victim]);
+                    spawned[victim] = &pool.spawn(monster_templates[types[monster_count + i]]);
+                }
+                pool_best.churn = std::min(pool_best.churn, seconds(started));
+                checksum += pool.size();
+
+                started = std::chrono::steady_clock::now();
+                pool.clear();
+                pool_best.reset = std::min(pool_best.reset, seconds(started));
+            }
+            {
+                std::vector<std::unique_ptr<HeapMonster>> monsters;
+                monsters.reserve(monster_count);
+                int next_id = 1;
+                auto started = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < monster_count; ++i)
+                {
+                    monsters.push_back(std::make_unique<HeapMonster>(monster_templates[types[i]], next_id++));
+                }
+                heap_best.fill = std::min(heap_best.fill, seconds(started));
+
+                started = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < replacements; ++i)
+                {
+                    monsters[victims[i]] = std::make_unique<HeapMonster>(monster_templates[types[monster_count + i]], next_id++);
+                }
+                heap_best.churn = std::min(heap_best.churn, seconds(started));
+                checksum += monsters.size();
+
+                started = std::chrono::steady_clock::now();
+                monsters.clear();
+                heap_best.reset = std::min(heap_best.reset, seconds(started));
+            }
+        }
+
+        auto report = [&](const char *label, const Times &best, size_t bytes)
+        {
+            std::cout << label << ": spawn " << monster_count / best.fill << "/sec, replace "
+                      << (replacements > 0 ? replacements / best.churn : 0.0) << "/sec, reset "
+                      << best.reset * 1000 << " ms, " << bytes << " bytes per monster\n";
+        };
+        std::cout << "Monsters: " << monster_count << ", replacements: " << replacements << ", best of " << trials
+                  << " trials\n";
+        report("MonsterPool", pool_best, sizeof(Monster));
+        report("make_unique", heap_best, sizeof(HeapMonster));
+        std::cout << "Checksum: " << checksum << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fatal error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
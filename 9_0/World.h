@@ -0,0 +1,523 @@
+#pragma once
+#include "Base_classes.h"
+#include <functional>
+#include <unordered_set>
+#include <type_traits>
+#include <limits>
+
+// ECS-мир для массовых симуляций: сущность — это только номер, её данные лежат
+// в плотных массивах компонентов. Каждая система проходит лишь по нужным ей компонентам,
+// а системы без общих записей делят массив между потоками.
+
+struct EntityId
+{
+    uint32_t index;
+    uint32_t generation; // Растёт при каждом переиспользовании номера, старые id становятся недействительными
+
+    bool operator==(const EntityId &other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const EntityId &other) const { return !(*this == other); }
+};
+
+inline constexpr EntityId no_entity{std::numeric_limits<uint32_t>::max(), 0};
+
+// Разреженное множество: sparse переводит номер сущности в позицию в плотных массивах,
+// удаление переносит последний элемент на место удалённого
+template <typename T>
+class SparseSet
+{
+private:
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> sparse;
+    std::vector<uint32_t> dense;
+    std::vector<T> components;
+
+public:
+    bool contains(uint32_t entity) const { return entity < sparse.size() && sparse[entity] != npos; }
+
+    T *find(uint32_t entity)
+    {
+        return contains(entity) ? &components[sparse[entity]] : nullptr;
+    }
+    const T *find(uint32_t entity) const
+    {
+        return contains(entity) ? &components[sparse[entity]] : nullptr;
+    }
+
+    T &insert(uint32_t entity, const T &value)
+    {
+        if (entity >= sparse.size())
+        {
+            sparse.resize(entity + 1, npos);
+        }
+        if (sparse[entity] != npos)
+        {
+            return components[sparse[entity]] = value;
+        }
+        sparse[entity] = static_cast<uint32_t>(dense.size());
+        dense.push_back(entity);
+        components.push_back(value);
+        return components.back();
+    }
+
+    void erase(uint32_t entity)
+    {
+        if (!contains(entity))
+        {
+            return;
+        }
+        uint32_t pos = sparse[entity];
+        uint32_t last = dense.back();
+        dense[pos] = last;
+        components[pos] = std::move(components.back());
+        sparse[last] = pos;
+        dense.pop_back();
+        components.pop_back();
+        sparse[entity] = npos;
+    }
+
+    void reserve(size_t count)
+    {
+        sparse.reserve(count);
+        dense.reserve(count);
+        components.reserve(count);
+    }
+
+    size_t size() const { return dense.size(); }
+    uint32_t entityAt(size_t pos) const { return dense[pos]; }
+    T &at(size_t pos) { return components[pos]; }
+    const T &at(size_t pos) const { return components[pos]; }
+};
+
+// Компоненты. Имя хранится один раз в мире или в таблице архетипов, у сущности — только ссылка
+struct Name
+{
+    std::string_view value;
+};
+
+struct Health
+{
+    int hp;
+    int max_hp;
+};
+
+struct Attack
+{
+    int value;
+    int defense_divisor; // Как у MonsterTemplate; у героя 1 — защита цели учитывается полностью
+};
+
+struct Defense
+{
+    int value;
+};
+
+struct Target
+{
+    EntityId entity;
+};
+
+struct Regeneration
+{
+    int per_tick;
+};
+
+struct Experience
+{
+    int level;
+    int experience;
+};
+
+struct MonsterKind
+{
+    const MonsterTemplate *type;
+};
+
+// Постоянные рабочие потоки для параллельных проходов по компонентам.
+// Вызывающий поток тоже берёт куски работы, поэтому при одном потоке пул не нужен вовсе
+class ParallelFor
+{
+public:
+    using Body = std::function<void(size_t begin, size_t end)>;
+
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable done;
+    const Body *job = nullptr;
+    size_t count = 0;
+    size_t chunk = 1;
+    std::atomic<size_t> next{0};
+    size_t busy = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    void work(const Body &body)
+    {
+        for (size_t begin = next.fetch_add(chunk); begin < count; begin = next.fetch_add(chunk))
+        {
+            body(begin, std::min(count, begin + chunk));
+        }
+    }
+
+    void runWorker()
+    {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            start.wait(lock, [&] { return stopping || (job && generation != seen); });
+            if (stopping)
+            {
+                return;
+            }
+            seen = generation;
+            const Body *current = job;
+            ++busy;
+            lock.unlock();
+            work(*current);
+            lock.lock();
+            if (--busy == 0)
+            {
+                done.notify_one();
+            }
+        }
+    }
+
+public:
+    explicit ParallelFor(size_t thread_count)
+    {
+        for (size_t i = 1; i < thread_count; ++i)
+        {
+            threads.emplace_back(&ParallelFor::runWorker, this);
+        }
+    }
+
+    ~ParallelFor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        start.notify_all();
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    ParallelFor(const ParallelFor &) = delete;
+    ParallelFor &operator=(const ParallelFor &) = delete;
+
+    size_t threadCount() const { return threads.size() + 1; }
+
+    // Делит [0, total) на куски и ждёт, пока все они будут обработаны
+    void run(size_t total, const Body &body)
+    {
+        const size_t min_chunk = 4096;
+        if (threads.empty() || total <= min_chunk)
+        {
+            body(0, total);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            count = total;
+            chunk = std::max(min_chunk, total / (threadCount() * 8));
+            next = 0;
+            job = &body;
+            ++generation;
+        }
+        start.notify_all();
+        work(body);
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return busy == 0; });
+        // Опоздавший поток не должен подхватить уже завершённую работу
+        job = nullptr;
+    }
+};
+
+class World
+{
+private:
+    std::vector<uint32_t> generations;
+    std::vector<uint32_t> free_indices;
+    size_t live_count = 0;
+
+    SparseSet<Name> names;
+    SparseSet<Health> healths;
+    SparseSet<Attack> attacks;
+    SparseSet<Defense> defenses;
+    SparseSet<Target> targets;
+    SparseSet<Regeneration> regenerations;
+    SparseSet<Experience> experiences;
+    SparseSet<MonsterKind> kinds;
+
+    std::unordered_set<std::string> name_pool; // Узлы не перемещаются, string_view на них остаются верными
+    ParallelFor pool;
+
+    std::vector<int> pending_damage; // Урон за тик по позициям в targets
+    std::vector<EntityId> dead;
+    uint64_t tick_count = 0;
+    uint64_t kills = 0;
+    uint64_t respawns = 0;
+
+    static const int exp_per_kill = 50;
+
+    template <typename T>
+    SparseSet<T> &storage()
+    {
+        if constexpr (std::is_same<T, Name>::value)
+            return names;
+        else if constexpr (std::is_same<T, Health>::value)
+            return healths;
+        else if constexpr (std::is_same<T, Attack>::value)
+            return attacks;
+        else if constexpr (std::is_same<T, Defense>::value)
+            return defenses;
+        else if constexpr (std::is_same<T, Target>::value)
+            return targets;
+        else if constexpr (std::is_same<T, Regeneration>::value)
+            return regenerations;
+        else if constexpr (std::is_same<T, Experience>::value)
+            return experiences;
+        else
+        {
+            static_assert(std::is_same<T, MonsterKind>::value, "Unknown component type");
+            return kinds;
+        }
+    }
+
+    // Фаза 1 параллельно считает урон каждого атакующего, фаза 2 последовательно применяет его:
+    // у одной цели может быть несколько атакующих, а последовательная запись обходится без атомиков
+    void combatSystem()
+    {
+        pending_damage.assign(targets.size(), 0);
+        pool.run(targets.size(), [this](size_t begin, size_t end)
+                 {
+                     for (size_t pos = begin; pos < end; ++pos)
+                     {
+                         uint32_t attacker = targets.entityAt(pos);
+                         EntityId target = targets.at(pos).entity;
+                         const Health *own = healths.find(attacker);
+                         const Attack *attack = attacks.find(attacker);
+                         if (!own || own->hp <= 0 || !attack || !alive(target))
+                         {
+                             continue;
+                         }
+                         const Health *victim = healths.find(target.index);
+                         if (!victim || victim->hp <= 0)
+                         {
+                             continue;
+                         }
+                         const Defense *defense = defenses.find(target.index);
+                         int armor = defense ? defense->value / attack->defense_divisor : 0;
+                         pending_damage[pos] = std::max(1, attack->value - armor);
+                     }
+                 });
+
+        for (size_t pos = 0; pos < pending_damage.size(); ++pos)
+        {
+            if (pending_damage[pos] == 0)
+            {
+                continue;
+            }
+            EntityId target = targets.at(pos).entity;
+            Health &victim = *healths.find(target.index);
+            if (victim.hp <= 0)
+            {
+                continue;
+            }
+            victim.hp = std::max(0, victim.hp - pending_damage[pos]);
+            if (victim.hp == 0)
+            {
+                ++kills;
+                dead.push_back(target);
+                if (Experience *experience = experiences.find(targets.entityAt(pos)))
+                {
+                    experience->experience += exp_per_kill;
+                }
+            }
+        }
+    }
+
+    // Те же правила, что в Character::applyExp
+    void levelUpSystem()
+    {
+        pool.run(experiences.size(), [this](size_t begin, size_t end)
+                 {
+                     for (size_t pos = begin; pos < end; ++pos)
+                     {
+                         Experience &experience = experiences.at(pos);
+                         uint32_t entity = experiences.entityAt(pos);
+                         while (experience.experience >= experience.level * 100)
+                         {
+                             experience.experience -= experience.level * 100;
+                             experience.level++;
+                             if (Health *health = healths.find(entity))
+                             {
+                                 health->max_hp += hero_archetype.hp_per_level;
+                                 health->hp = health->max_hp;
+                             }
+                             if (Attack *attack = attacks.find(entity))
+                                 attack->value += hero_archetype.attack_per_level;
+                             if (Defense *defense = defenses.find(entity))
+                                 defense->value += hero_archetype.defense_per_level;
+                         }
+                     }
+                 });
+    }
+
+    void healSystem()
+    {
+        pool.run(regenerations.size(), [this](size_t begin, size_t end)
+                 {
+                     for (size_t pos = begin; pos < end; ++pos)
+                     {
+                         Health *health = healths.find(regenerations.entityAt(pos));
+                         if (health && health->hp > 0)
+                         {
+                             health->hp = std::min(health->max_hp, health->hp + regenerations.at(pos).per_tick);
+                         }
+                     }
+                 });
+    }
+
+    // Погибший монстр заменяется новым того же типа, как в Game::battle, погибший герой воскресает.
+    // Новый монстр занимает компоненты прежнего: пересоздание всех компонентов стоило бы дороже
+    void spawnSystem()
+    {
+        for (EntityId entity : dead)
+        {
+            Health *health = get<Health>(entity);
+            if (!health || health->hp > 0)
+            {
+                continue;
+            }
+            ++respawns;
+            health->hp = health->max_hp;
+        }
+        dead.clear();
+    }
+
+public:
+    explicit World(size_t threads = std::max(1u, std::thread::hardware_concurrency())) : pool(threads) {}
+
+    void reserve(size_t count)
+    {
+        generations.reserve(count);
+        names.reserve(count);
+        healths.reserve(count);
+        attacks.reserve(count);
+        defenses.reserve(count);
+        targets.reserve(count);
+        regenerations.reserve(count);
+        experiences.reserve(count);
+        kinds.reserve(count);
+    }
+
+    EntityId create()
+    {
+        ++live_count;
+        if (!free_indices.empty())
+        {
+            uint32_t index = free_indices.back();
+            free_indices.pop_back();
+            return EntityId{index, generations[index]};
+        }
+        generations.push_back(0);
+        return EntityId{static_cast<uint32_t>(generations.size() - 1), 0};
+    }
+
+    void destroy(EntityId entity)
+    {
+        if (!alive(entity))
+        {
+            return;
+        }
+        names.erase(entity.index);
+        healths.erase(entity.index);
+        attacks.erase(entity.index);
+        defenses.erase(entity.index);
+        targets.erase(entity.index);
+        regenerations.erase(entity.index);
+        experiences.erase(entity.index);
+        kinds.erase(entity.index);
+        ++generations[entity.index];
+        free_indices.push_back(entity.index);
+        --live_count;
+    }
+
+    bool alive(EntityId entity) const
+    {
+        return entity.index < generations.size() && generations[entity.index] == entity.generation;
+    }
+
+    template <typename T>
+    T &add(EntityId entity, const T &component)
+    {
+        if (!alive(entity))
+        {
+            throw std::invalid_argument("Entity does not exist");
+        }
+        return storage<T>().insert(entity.index, component);
+    }
+
+    template <typename T>
+    T *get(EntityId entity)
+    {
+        return alive(entity) ? storage<T>().find(entity.index) : nullptr;
+    }
+
+    // Одинаковые имена героев хранятся в мире один раз
+    std::string_view internName(const std::string &name)
+    {
+        return *name_pool.insert(name).first;
+    }
+
+    EntityId spawnMonster(const MonsterTemplate &type)
+    {
+        EntityId entity = create();
+        add(entity, Name{type.name});
+        add(entity, Health{type.hp, type.hp});
+        add(entity, Attack{type.attack, type.defense_divisor});
+        add(entity, Defense{type.defense});
+        add(entity, MonsterKind{&type});
+        return entity;
+    }
+
+    EntityId spawnHero(const std::string &name, int regeneration = 1)
+    {
+        EntityId entity = create();
+        add(entity, Name{internName(name)});
+        add(entity, Health{hero_archetype.hp, hero_archetype.hp});
+        add(entity, Attack{hero_archetype.attack, 1});
+        add(entity, Defense{hero_archetype.defense});
+        add(entity, Experience{1, 0});
+        add(entity, Regeneration{regeneration});
+        return entity;
+    }
+
+    // Сущности атакуют друг друга каждый тик, пока одна из них не погибнет
+    void fight(EntityId first, EntityId second)
+    {
+        add(first, Target{second});
+        add(second, Target{first});
+    }
+
+    // Один шаг симуляции: все атаки тика происходят одновременно
+    void tick()
+    {
+        combatSystem();
+        levelUpSystem();
+        healSystem();
+        spawnSystem();
+        ++tick_count;
+    }
+
+    size_t size() const { return live_count; }
+    size_t threadCount() const { return pool.threadCount(); }
+    uint64_t getTicks() const { return tick_count; }
+    uint64_t getKills() const { return kills; }
+    uint64_t getRespawns() const { return respawns; }
+};
@@ -0,0 +1,65 @@
+#include "Base_realization.cpp"
+#include "World.h"
+#include <algorithm>
+
+// Замер времени тика ECS-мира: герои попарно сражаются с монстрами всех типов.
+// Запуск: World_benchmark [сущностей] [тиков] [потоков]
+int main(int argc, char *argv[])
+{
+    try
+    {
+        size_t entity_count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+        size_t tick_count = argc > 2 ? std::stoul(argv[2]) : 600;
+        size_t threads = argc > 3 ? std::stoul(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+
+        World world(threads);
+        world.reserve(entity_count);
+        auto setup_started = std::chrono::steady_clock::now();
+        for (size_t i = 0; i + 1 < entity_count; i += 2)
+        {
+            EntityId hero = world.spawnHero("Player_" + std::to_string(i / 2 % 1000));
+            EntityId monster = world.spawnMonster(monster_templates[i / 2 % MonsterTypeCount]);
+            world.fight(hero, monster);
+        }
+        double setup_ms =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - setup_started).count();
+
+        std::vector<double> tick_times;
+        tick_times.reserve(tick_count);
+        for (size_t i = 0; i < tick_count; ++i)
+        {
+            auto started = std::chrono::steady_clock::now();
+            world.tick();
+            tick_times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count());
+        }
+
+        double total = 0;
+        for (double time : tick_times)
+        {
+            total += time;
+        }
+        std::sort(tick_times.begin(), tick_times.end());
+        auto percentile = [&tick_times](double p)
+        {
+            return tick_times.empty() ? 0.0 : tick_times[std::min(tick_times.size() - 1, static_cast<size_t>(p * tick_times.size()))];
+        };
+        double average = tick_times.empty() ? 0.0 : total / tick_times.size();
+        const double frame_budget_ms = 1000.0 / 60;
+
+        std::cout << "Entities: " << world.size() << ", threads: " << world.threadCount()
+                  << ", setup: " << setup_ms << " ms\n"
+                  << "Ticks: " << world.getTicks() << ", kills: " << world.getKills()
+                  << ", respawns: " << world.getRespawns() << "\n"
+                  << "Tick time avg: " << average << " ms, p50: " << percentile(0.50)
+                  << " ms, p99: " << percentile(0.99) << " ms, max: " << (tick_times.empty() ? 0.0 : tick_times.back())
+                  << " ms\n"
+                  << "Max rate: " << (average > 0 ? 1000.0 / average : 0.0) << " ticks/sec, 60 ticks/sec "
+                  << (percentile(0.99) <= frame_budget_ms ? "sustained" : "not sustained") << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fatal error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
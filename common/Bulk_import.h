@@ -0,0 +1,344 @@
+#pragma once
+// Общие части массового импорта CSV и JSON Lines (8_0 — люди, 10_0 — пользователи):
+// файл отображается в память, делится на куски из целых строк, куски разбираются параллельно
+#include "Mapped_file.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <exception>
+#include <thread>
+#include <utility>
+
+// Выполняет work(0..count-1) в threads потоках: каждый поток берёт следующий номер из общего счётчика.
+// Исключение из потока пробрасывается после join
+template <typename Work>
+void runParallel(size_t count, size_t threads, Work work)
+{
+    threads = std::max<size_t>(1, std::min(threads, count));
+    std::atomic<size_t> next{0};
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t < threads; ++t)
+    {
+        pool.emplace_back([&, t]
+                          {
+                              try
+                              {
+                                  for (size_t i = next++; i < count; i = next++)
+                                      work(i);
+                              }
+                              catch (...)
+                              {
+                                  errors[t] = std::current_exception();
+                              } });
+    }
+    for (std::thread &thread : pool)
+        thread.join();
+    for (const std::exception_ptr &error : errors)
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
+
+inline bool parseInt(std::string_view text, int &value)
+{
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+// Делит строку CSV ровно на count полей. Поле без кавычек — срез строки, поле в кавычках
+// ("" внутри означает кавычку) раскрывается в scratch[i]. Перевод строки внутри кавычек не поддерживается
+inline bool splitCsv(std::string_view line, std::string_view *fields, size_t count, std::string *scratch)
+{
+    size_t pos = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (pos < line.size() && line[pos] == '"')
+        {
+            std::string &value = scratch[i];
+            value.clear();
+            ++pos;
+            while (true)
+            {
+                size_t quote = line.find('"', pos);
+                if (quote == std::string_view::npos)
+                    return false;
+                value.append(line.data() + pos, quote - pos);
+                pos = quote + 1;
+                if (pos < line.size() && line[pos] == '"')
+                {
+                    value += '"';
+                    ++pos;
+                }
+                else
+                    break;
+            }
+            fields[i] = value;
+        }
+        else
+        {
+            size_t end = std::min(line.find(',', pos), line.size());
+            fields[i] = line.substr(pos, end - pos);
+            pos = end;
+        }
+        if (i + 1 == count)
+            return pos == line.size();
+        if (pos == line.size() || line[pos] != ',')
+            return false;
+        ++pos;
+    }
+    return count == 0 && line.empty();
+}
+
+// Разбор плоского объекта JSON, записанного в одну строку
+class JsonCursor
+{
+private:
+    std::string_view text;
+    size_t pos = 0;
+
+    static void appendUtf8(std::string &out, unsigned code)
+    {
+        if (code < 0x80)
+            out += static_cast<char>(code);
+        else if (code < 0x800)
+        {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else
+        {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+public:
+    explicit JsonCursor(std::string_view text) : text(text) {}
+
+    void skipSpace()
+    {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t'))
+            ++pos;
+    }
+    bool consume(char c)
+    {
+        skipSpace();
+        if (pos < text.size() && text[pos] == c)
+        {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+    bool peek(char c)
+    {
+        skipSpace();
+        return pos < text.size() && text[pos] == c;
+    }
+    bool atEnd()
+    {
+        skipSpace();
+        return pos == text.size();
+    }
+
+    // Строка без escape-последовательностей возвращается срезом, иначе раскрывается в scratch.
+    // \u поддерживается только для символов BMP без суррогатных пар
+    bool string(std::string_view &value, std::string &scratch)
+    {
+        if (!consume('"'))
+            return false;
+        size_t start = pos;
+        size_t end = pos;
+        while (end < text.size() && text[end] != '"' && text[end] != '\\')
+            ++end;
+        if (end == text.size())
+            return false;
+        if (text[end] == '"')
+        {
+            value = text.substr(start, end - start);
+            pos = end + 1;
+            return true;
+        }
+        scratch.assign(text.data() + start, end - start);
+        pos = end;
+        while (pos < text.size())
+        {
+            char c = text[pos++];
+            if (c == '"')
+            {
+                value = scratch;
+                return true;
+            }
+            if (c != '\\')
+            {
+                scratch += c;
+                continue;
+            }
+            if (pos == text.size())
+                return false;
+            switch (text[pos++])
+            {
+            case '"': scratch += '"'; break;
+            case '\\': scratch += '\\'; break;
+            case '/': scratch += '/'; break;
+            case 'b': scratch += '\b'; break;
+            case 'f': scratch += '\f'; break;
+            case 'n': scratch += '\n'; break;
+            case 'r': scratch += '\r'; break;
+            case 't': scratch += '\t'; break;
+            case 'u':
+            {
+                unsigned code = 0;
+                if (text.size() - pos < 4 ||
+                    std::from_chars(text.data() + pos, text.data() + pos + 4, code, 16).ptr != text.data() + pos + 4 ||
+                    (code >= 0xD800 && code <= 0xDFFF))
+                    return false;
+                pos += 4;
+                appendUtf8(scratch, code);
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+        return false;
+    }
+
+    // Число, true, false или null — срезом строки
+    bool scalar(std::string_view &value)
+    {
+        skipSpace();
+        size_t start = pos;
+        while (pos < text.size() && text[pos] != ',' && text[pos] != '}' && text[pos] != ' ' && text[pos] != '\t')
+            ++pos;
+        value = text.substr(start, pos - start);
+        return pos > start;
+    }
+};
+
+// Значения ключей keys попадают в fields, незнакомые ключи пропускаются; scratch — count + 1 строк.
+// Возвращает маску найденных ключей или -1 при ошибке синтаксиса; вложенные объекты не поддерживаются
+inline int parseJson(std::string_view line, const std::string_view *keys, size_t count, std::string_view *fields,
+                     std::string *scratch)
+{
+    JsonCursor in(line);
+    if (!in.consume('{'))
+        return -1;
+    int found = 0;
+    if (in.consume('}'))
+        return in.atEnd() ? found : -1;
+    size_t expected = 0; // Обычно ключи идут в порядке keys, поэтому сначала проверяется следующий
+    do
+    {
+        std::string_view key, value;
+        if (!in.string(key, scratch[count]) || !in.consume(':'))
+            return -1;
+        size_t field = expected < count && keys[expected] == key
+                           ? expected
+                           : static_cast<size_t>(std::find(keys, keys + count, key) - keys);
+        expected = field + 1;
+        std::string &target = scratch[std::min(field, count)];
+        if (in.peek('"') ? !in.string(value, target) : !in.scalar(value))
+            return -1;
+        if (field < count)
+        {
+            fields[field] = value;
+            found |= 1 << field;
+        }
+    } while (in.consume(','));
+    return in.consume('}') && in.atEnd() ? found : -1;
+}
+
+enum class ImportFormat
+{
+    Csv,      // Поля через запятую; строка заголовка пропускается
+    JsonLines // Плоский объект JSON на строку
+};
+
+struct ImportStats
+{
+    size_t imported = 0;
+    size_t rejected = 0;
+};
+
+const size_t minImportChunk = 1 << 20;
+
+// Данные импорта без строки заголовка CSV
+struct ImportText
+{
+    ImportFormat format;
+    const char *begin;
+    const char *end;
+    size_t headerLines;
+};
+
+// JSON Lines, если первый непробельный символ '{', иначе CSV; первая строка CSV, начинающаяся
+// с csvHeader, считается заголовком
+inline ImportText detectImport(const MappedFile &file, std::string_view csvHeader)
+{
+    ImportText text{ImportFormat::Csv, file.data(), file.data() + file.size(), 0};
+    const char *first = text.begin;
+    while (first < text.end && std::isspace(static_cast<unsigned char>(*first)))
+        ++first;
+    if (first < text.end && *first == '{')
+        text.format = ImportFormat::JsonLines;
+    else if (file.size() >= csvHeader.size() && std::string_view(text.begin, csvHeader.size()) == csvHeader)
+    {
+        const char *newline = static_cast<const char *>(std::memchr(text.begin, '\n', text.end - text.begin));
+        text.begin = newline ? newline + 1 : text.end;
+        text.headerLines = 1;
+    }
+    return text;
+}
+
+// Делит данные на куски из целых строк: не меньше minImportChunk байт и не больше threads * 4 кусков
+inline std::vector<std::pair<const char *, const char *>> splitLineChunks(const ImportText &text, size_t threads)
+{
+    size_t bytes = static_cast<size_t>(text.end - text.begin);
+    size_t chunkCount = std::max<size_t>(1, std::min(bytes / minImportChunk, std::max<size_t>(1, threads) * 4));
+    std::vector<std::pair<const char *, const char *>> chunks(chunkCount);
+    const char *p = text.begin;
+    for (size_t k = 0; k < chunkCount; ++k)
+    {
+        chunks[k].first = p;
+        if (k + 1 == chunkCount)
+            p = text.end;
+        else
+        {
+            const char *target = std::max(p, text.begin + bytes * (k + 1) / chunkCount);
+            const char *newline = static_cast<const char *>(std::memchr(target, '\n', text.end - target));
+            p = newline ? newline + 1 : text.end;
+        }
+        chunks[k].second = p;
+    }
+    return chunks;
+}
+
+// Вызывает function(номер строки от begin, строка) для каждой непустой строки, '\r' в конце отрезается.
+// Возвращает число строк, включая пустые
+template <typename Function>
+size_t forEachLine(const char *begin, const char *end, Function function)
+{
+    size_t lines = 0;
+    const char *p = begin;
+    while (p < end)
+    {
+        const char *newline = static_cast<const char *>(std::memchr(p, '\n', end - p));
+        std::string_view line(p, (newline ? newline : end) - p);
+        p = newline ? newline + 1 : end;
+        ++lines;
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        if (!line.empty())
+            function(lines, line);
+    }
+    return lines;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <charconv>
+#include <type_traits>
+
+// Буфер форматирования текущего потока: числа пишутся через std::to_chars, готовый текст
+// уходит в поток одним write. После записи ёмкость сохраняется, поэтому повторный вывод не выделяет память
+class TextBuffer
+{
+private:
+    std::string text;
+
+public:
+    static TextBuffer &local()
+    {
+        thread_local TextBuffer buffer;
+        return buffer;
+    }
+
+    TextBuffer &operator<<(std::string_view value)
+    {
+        text.append(value.data(), value.size());
+        return *this;
+    }
+    TextBuffer &operator<<(char value)
+    {
+        text += value;
+        return *this;
+    }
+    template <typename Number, typename = std::enable_if_t<std::is_integral<Number>::value>>
+    TextBuffer &operator<<(Number value)
+    {
+        char digits[24];
+        text.append(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr);
+        return *this;
+    }
+
+    size_t size() const { return text.size(); }
+
+    // Пишет накопленный текст без сброса потока
+    void writeTo(std::ostream &out)
+    {
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        text.clear();
+    }
+};